@@ -0,0 +1,136 @@
+#include "AhoCorasick.h"
+#include "Stats.h"
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+/******* PRIVATE FUNCTION DECLARATIONS *********/
+
+bool scanOrder(const Match& a, const Match& b);
+
+// Node 0 is the root. A node's output is the nearest node on its fail
+// chain (itself included) that ends a word, or -1.
+AhoCorasick::AhoCorasick(const Dictionary& dict, int minLength)
+{
+  nodes.push_back({0, -1, -1, 0, -1, 0, -1});
+  for (int i = 0; i < dict.size(); i++)
+  {
+    std::string word = dict.getWord(i);
+    if ((int)word.length() < minLength)
+    {
+      continue;
+    }
+    int node = 0;
+    for (int j = 0; j < word.length(); j++)
+    {
+      int next = child(node, word[j]);
+      if (next == -1)
+      {
+        next = nodes.size();
+        nodes.push_back({word[j], -1, nodes[node].child, 0, -1, 0, -1});
+        nodes[node].child = next;
+      }
+      node = next;
+    }
+    nodes[node].length = word.length();
+    if (nodes[node].word == -1)
+    {
+      nodes[node].word = i;
+    }
+  }
+
+  // breadth first, so every fail target is finished before it is used
+  std::vector<int> queue;
+  queue.push_back(0);
+  for (int q = 0; q < queue.size(); q++)
+  {
+    int node = queue[q];
+    for (int i = nodes[node].child; i != -1; i = nodes[i].sibling)
+    {
+      if (node != 0)
+      {
+        nodes[i].fail = step(nodes[node].fail, nodes[i].letter);
+      }
+      nodes[i].output = nodes[i].length > 0 ? i : nodes[nodes[i].fail].output;
+      queue.push_back(i);
+    }
+  }
+}
+
+int AhoCorasick::step(int node, char letter) const
+{
+  int next = child(node, letter);
+  while (next == -1 && node != 0)
+  {
+    node = nodes[node].fail;
+    next = child(node, letter);
+  }
+  return next == -1 ? 0 : next;
+}
+
+// Streams every line of the grid in all 8 directions. A hit is kept when
+// it starts inside the line proper; later starts repeat earlier ones via
+// the wrapped tail. Sorting by cell, direction and length reproduces the
+// order of the per-cell search.
+std::vector<Match> AhoCorasick::findMatches(const Grid& grid, int directions, bool wrap) const
+{
+  std::vector<Match> found;
+  for (int direction = 0; direction < Grid::DIRECTIONS; direction++)
+  {
+    if (!(directions >> direction & 1))
+    {
+      continue;
+    }
+    int lineLength = grid.getLineLength(direction);
+    int streamLength = lineLength + grid.getRayLength() - 1;
+    for (int line = 0; line < grid.getLineCount(direction); line++)
+    {
+      const char* letters = grid.getLine(direction, line);
+      int node = 0;
+      STATS_ADD(rays, 1);
+      STATS_ADD(letters, streamLength);
+      for (int i = 0; i < streamLength; i++)
+      {
+        node = step(node, letters[i]);
+        for (int out = nodes[node].output; out != -1; out = nodes[nodes[out].fail].output)
+        {
+          int start = i + 1 - nodes[out].length;
+          if (start < lineLength)
+          {
+            Match match;
+            grid.getLineCell(direction, line, start, match.col, match.row);
+            match.word = nodes[out].word;
+            match.direction = direction;
+            match.length = nodes[out].length;
+            if (!wrap && match.length > grid.getEdgeDistance(match.col, match.row, direction))
+            {
+              continue;
+            }
+            found.push_back(match);
+            STATS_ADD(matches, 1);
+          }
+        }
+      }
+    }
+  }
+
+  std::sort(found.begin(), found.end(), scanOrder);
+  return found;
+}
+
+bool scanOrder(const Match& a, const Match& b)
+{
+  if (a.row != b.row)
+  {
+    return a.row < b.row;
+  }
+  if (a.col != b.col)
+  {
+    return a.col < b.col;
+  }
+  if (a.direction != b.direction)
+  {
+    return a.direction < b.direction;
+  }
+  return a.length < b.length;
+}
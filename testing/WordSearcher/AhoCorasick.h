@@ -0,0 +1,47 @@
+#include <vector>
+#include <iostream>
+#include "Dictionary.h"
+#include "Grid.h"
+#include "MatchSink.h"
+
+#ifndef AHOCORASICK_H
+#define AHOCORASICK_H
+
+// Multi-pattern automaton over the dictionary. Streams whole grid lines
+// instead of walking one ray per cell.
+class AhoCorasick
+{
+public:
+  AhoCorasick(const Dictionary& dict, int minLength);
+  // directions is a bit mask over Grid directions; without wrap, hits
+  // that run off the edge are dropped
+  std::vector<Match> findMatches(const Grid& grid, int directions, bool wrap) const;
+private:
+  struct Node
+  {
+    char letter;
+    int child;
+    int sibling;
+    int fail;
+    int output;
+    int length;
+    int word;
+  };
+  inline int child(int node, char letter) const;
+  int step(int node, char letter) const;
+  std::vector<Node> nodes;
+};
+
+int AhoCorasick::child(int node, char letter) const
+{
+  for (int i = nodes[node].child; i != -1; i = nodes[i].sibling)
+  {
+    if (nodes[i].letter == letter)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+#endif //AHOCORASICK_H
@@ -0,0 +1,150 @@
+#include "Batch.h"
+#include "Session.h"
+#include "Stats.h"
+#include <vector>
+#include <string>
+#include <deque>
+#include <algorithm>
+#ifdef _GLIBCXX_HAS_GTHREADS
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+/******* PRIVATE FUNCTION DECLARATIONS *********/
+
+std::vector<Match> solveGrid(const WordSearcher& searcher, std::string filename);
+
+#ifdef _GLIBCXX_HAS_GTHREADS
+// One worker's files, taken from the front by the owner and from the
+// back by thieves.
+struct WorkQueue
+{
+  std::mutex lock;
+  std::deque<int> grids;
+};
+
+bool takeGrid(WorkQueue& queue, bool steal, int& grid);
+#endif
+
+void solveBatch(const WordSearcher& searcher, const std::vector<std::string>& filenames, int workers, MatchSink& sink)
+{
+  int count = filenames.size();
+#ifdef _GLIBCXX_HAS_GTHREADS
+  if (workers <= 0) {
+    workers = std::thread::hardware_concurrency();
+  }
+  if (workers > count) {workers = count;}
+#else
+  workers = 1;
+#endif
+  if (workers <= 1) {
+    for (int i = 0; i < count; i++) {
+      std::vector<Match> matches = solveGrid(searcher, filenames[i]);
+      sink.beginGrid(filenames[i]);
+      for (int j = 0; j < matches.size(); j++) {
+        sink.add(matches[j]);
+      }
+    }
+    return;
+  }
+
+#ifdef _GLIBCXX_HAS_GTHREADS
+  // contiguous runs, so without stealing each worker walks its share in
+  // input order and the writer rarely waits
+  std::vector<WorkQueue> queues(workers);
+  for (int i = 0; i < count; i++) {
+    queues[(long)i * workers / count].grids.push_back(i);
+  }
+  std::vector<std::vector<Match>> results(count);
+  std::vector<char> done(count, 0);
+  std::mutex doneLock;
+  std::condition_variable doneSignal;
+  std::vector<Stats> workerStats(workers);
+
+  std::vector<std::thread> threads;
+  for (int w = 0; w < workers; w++) {
+    threads.push_back(std::thread([&, w]() {
+      int grid;
+      for (;;) {
+        bool found = takeGrid(queues[w], false, grid);
+        for (int v = 1; !found && v < workers; v++) {
+          found = takeGrid(queues[(w + v) % workers], true, grid);
+        }
+        if (!found) {break;}
+        results[grid] = solveGrid(searcher, filenames[grid]);
+        std::lock_guard<std::mutex> guard(doneLock);
+        done[grid] = 1;
+        doneSignal.notify_one();
+      }
+      STATS_TAKE(workerStats[w]);
+    }));
+  }
+
+  for (int i = 0; i < count; i++) {
+    {
+      std::unique_lock<std::mutex> guard(doneLock);
+      doneSignal.wait(guard, [&]() { return done[i] != 0; });
+    }
+    sink.beginGrid(filenames[i]);
+    for (int j = 0; j < results[i].size(); j++) {
+      sink.add(results[i][j]);
+    }
+    std::vector<Match>().swap(results[i]);
+  }
+  for (int w = 0; w < workers; w++) {
+    threads[w].join();
+    STATS_MERGE(workerStats[w]);
+  }
+#endif
+}
+
+std::vector<std::string> listGrids(std::string directory)
+{
+  std::vector<std::string> filenames;
+#if defined(__unix__) || defined(__APPLE__)
+  DIR* dir = opendir(directory.c_str());
+  if (dir == NULL) {
+    return filenames;
+  }
+  for (struct dirent* entry = readdir(dir); entry != NULL; entry = readdir(dir)) {
+    std::string path = directory + "/" + entry->d_name;
+    struct stat info;
+    if (stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode)) {
+      filenames.push_back(path);
+    }
+  }
+  closedir(dir);
+  std::sort(filenames.begin(), filenames.end());
+#endif
+  return filenames;
+}
+
+std::vector<Match> solveGrid(const WordSearcher& searcher, std::string filename)
+{
+  Grid grid = Session::parseGrid(filename);
+  STATS_TIMER(searchMs);
+  return searcher.solve(grid, 1);
+}
+
+#ifdef _GLIBCXX_HAS_GTHREADS
+bool takeGrid(WorkQueue& queue, bool steal, int& grid)
+{
+  std::lock_guard<std::mutex> guard(queue.lock);
+  if (queue.grids.empty()) {
+    return false;
+  }
+  if (steal) {
+    grid = queue.grids.back();
+    queue.grids.pop_back();
+  } else {
+    grid = queue.grids.front();
+    queue.grids.pop_front();
+  }
+  return true;
+}
+#endif
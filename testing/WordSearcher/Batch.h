@@ -0,0 +1,19 @@
+#include <vector>
+#include <string>
+#include "WordSearcher.h"
+#include "MatchSink.h"
+
+#ifndef BATCH_H
+#define BATCH_H
+
+// Solves many grid files against one shared searcher. Each worker owns a
+// queue of files and steals from the back of the others' once its own
+// runs dry; every grid is searched on a single thread. The sink gets the
+// grids in input order, each as soon as it and all before it are done.
+// workers: 0 = one per hardware thread.
+void solveBatch(const WordSearcher& searcher, const std::vector<std::string>& filenames, int workers, MatchSink& sink);
+
+// the regular files in a directory, sorted by name
+std::vector<std::string> listGrids(std::string directory);
+
+#endif //BATCH_H
@@ -3,37 +3,277 @@
 #include <iostream>
 #include <vector>
 #include <fstream>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ranges this short are finished with insertion sort
+const int SMALL_RANGE = 16;
+
+// Binary dictionary: the header, then per word a (text offset, length)
+// pair of uint32, then the trie nodes, the lookup keys, key tree and key
+// order, the hash buckets and slots and the prefix tables, each as laid
+// out in memory, then the word text back to back. Native byte order.
+const char BINARY_MAGIC[8] = "WSDICT\0";
+const uint32_t BINARY_VERSION = 2;
+
+struct BinaryHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t nodeSize;
+  uint32_t words;
+  uint32_t longestWord;
+  uint64_t nodes;
+  uint64_t textBytes;
+  uint64_t keyBlocks;
+  uint64_t hashSlots;
+};
 
 /******* PRIVATE FUNCTION DECLARATIONS *********/
 
-void convertToLower(char* str, int len);
+std::shared_ptr<char> loadFile(const std::string& filename, size_t& length);
+void convertToLower(char* str, size_t len);
+int charAt(std::string_view word, int depth);
+int depthBudget(int n);
+template <typename T>
+void writeSection(std::ofstream& outfile, const std::vector<T>& items);
+template <typename T>
+const char* readSection(const char* data, std::vector<T>& items, uint64_t count);
+bool validIndex(int index, uint64_t limit);
 
 Dictionary::Dictionary(void)
 {
-  wordlist = std::vector<std::string>();
+  wordlist = std::vector<std::string_view>();
   longestWord = 0;
+  packed = false;
+  buildPrefixTables();
 }
 
+// Loads the file as one arena, lowercases it in place and records each
+// non-empty line as a view into it.
 void Dictionary::readWords(std::string filename)
 {
-  std::ifstream infile(filename);
-  std::string next;
-  while(getline(infile, next))
+  size_t length = 0;
+  std::shared_ptr<char> arena = loadFile(filename, length);
+  if (!arena)
+  {
+    return;
+  }
+  char* text = arena.get();
+  convertToLower(text, length);
+  wordlist.reserve(wordlist.size() + std::count(text, text + length, '\n') + 1);
+  size_t start = 0;
+  for (size_t i = 0; i <= length; i++)
+  {
+    if (i < length && text[i] != '\n')
+    {
+      continue;
+    }
+    size_t end = i;
+    if (end > start && text[end - 1] == '\r')
+    {
+      end--;
+    }
+    if (end > start)
+    {
+      wordlist.push_back(std::string_view(text + start, end - start));
+      if (end - start > longestWord)
+      {
+        longestWord = end - start;
+      }
+    }
+    start = i + 1;
+  }
+  arenas.push_back(arena);
+}
+
+// Writes the words in their current order along with the trie and the
+// lookup structures, so save after sorting and buildIndex.
+bool Dictionary::saveBinary(std::string filename) const
+{
+  std::ofstream outfile(filename, std::ios::binary);
+  if (!outfile)
+  {
+    return false;
+  }
+  BinaryHeader header;
+  std::memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+  header.version = BINARY_VERSION;
+  header.nodeSize = sizeof(TrieNode);
+  header.words = size();
+  header.longestWord = longestWord;
+  header.nodes = trie.size();
+  header.textBytes = 0;
+  header.keyBlocks = keyTree.size();
+  header.hashSlots = hashSlots.size();
+
+  std::vector<uint32_t> table;
+  table.reserve(2 * size());
+  for (int i = 0; i < size(); i++)
+  {
+    table.push_back(header.textBytes);
+    table.push_back(getWord(i).length());
+    header.textBytes += getWord(i).length();
+  }
+
+  outfile.write((const char*)&header, sizeof(header));
+  writeSection(outfile, table);
+  writeSection(outfile, trie);
+  writeSection(outfile, keys);
+  writeSection(outfile, keyTree);
+  writeSection(outfile, keyOrder);
+  writeSection(outfile, hashBuckets);
+  writeSection(outfile, hashSlots);
+  outfile.write((const char*)prefix2, sizeof(prefix2));
+  outfile.write((const char*)prefix3, sizeof(prefix3));
+  for (int i = 0; i < size(); i++)
+  {
+    std::string word = getWord(i);
+    outfile.write(word.data(), word.length());
+  }
+  return outfile.good();
+}
+
+// Replaces the contents with a file written by saveBinary. The word text
+// stays in the mapped file and the index structures are copied as they
+// were saved; nothing is sorted or rebuilt. Every stored index is range
+// checked, so a corrupt or stale file is rejected rather than walked.
+bool Dictionary::loadBinary(std::string filename)
+{
+  size_t length = 0;
+  std::shared_ptr<char> arena = loadFile(filename, length);
+  BinaryHeader header;
+  if (!arena || length < sizeof(header))
+  {
+    return false;
+  }
+  std::memcpy(&header, arena.get(), sizeof(header));
+  if (std::memcmp(header.magic, BINARY_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != BINARY_VERSION || header.nodeSize != sizeof(TrieNode) ||
+      header.nodes == 0 || header.nodes > INT32_MAX || header.words > INT32_MAX ||
+      header.keyBlocks != (header.words + KEY_BLOCK - 1) / KEY_BLOCK || header.hashSlots > INT32_MAX)
+  {
+    return false;
+  }
+  uint64_t tableBytes = 2 * sizeof(uint32_t) * (uint64_t)header.words;
+  uint64_t indexBytes = sizeof(TrieNode) * header.nodes + sizeof(uint64_t) * (uint64_t)header.words +
+                        (sizeof(KeyBlock) + KEY_BLOCK * sizeof(int)) * header.keyBlocks +
+                        sizeof(HashBucket) * (header.longestWord + 1ULL) + sizeof(HashSlot) * header.hashSlots +
+                        sizeof(prefix2) + sizeof(prefix3);
+  if (length != sizeof(header) + tableBytes + indexBytes + header.textBytes)
+  {
+    return false;
+  }
+
+  const char* data = arena.get() + sizeof(header);
+  const uint32_t* table = (const uint32_t*)data;
+  const char* text = data + tableBytes + indexBytes;
+  std::vector<std::string_view> words;
+  words.reserve(header.words);
+  for (uint32_t i = 0; i < header.words; i++)
+  {
+    if ((uint64_t)table[2 * i] + table[2 * i + 1] > header.textBytes || table[2 * i + 1] > header.longestWord)
+    {
+      return false;
+    }
+    words.push_back(std::string_view(text + table[2 * i], table[2 * i + 1]));
+  }
+
+  std::vector<TrieNode> nodes;
+  std::vector<uint64_t> wordKeys;
+  std::vector<KeyBlock> blocks;
+  std::vector<int> order;
+  std::vector<HashBucket> buckets;
+  std::vector<HashSlot> slots;
+  data = readSection(data + tableBytes, nodes, header.nodes);
+  data = readSection(data, wordKeys, header.words);
+  data = readSection(data, blocks, header.keyBlocks);
+  data = readSection(data, order, header.keyBlocks * KEY_BLOCK);
+  data = readSection(data, buckets, header.longestWord + 1ULL);
+  data = readSection(data, slots, header.hashSlots);
+  // buildIndex appends children after their parent and links each to
+  // the siblings added before it, so walks cannot loop
+  for (uint64_t i = 0; i < header.nodes; i++)
+  {
+    if (!validIndex(nodes[i].child, header.nodes) || !validIndex(nodes[i].sibling, header.nodes) ||
+        !validIndex(nodes[i].word, header.words) ||
+        (nodes[i].child != -1 && (uint64_t)nodes[i].child <= i) ||
+        (nodes[i].sibling != -1 && (uint64_t)nodes[i].sibling >= i))
+    {
+      return false;
+    }
+  }
+  // padding slots hold UINT64_MAX and the word count; every other slot
+  // names a word with the slot's key
+  for (uint64_t i = 0; i < order.size(); i++)
+  {
+    uint64_t key = blocks[i / KEY_BLOCK].key[i % KEY_BLOCK];
+    bool valid = key == UINT64_MAX ? order[i] == (int)header.words :
+                 order[i] >= 0 && order[i] < (int)header.words && wordKeys[order[i]] == key;
+    if (!valid)
+    {
+      return false;
+    }
+  }
+  for (uint64_t i = 0; i < slots.size(); i++)
   {
-    wordlist.push_back(next);
-    convertToLower(&wordlist[wordlist.size()-1][0], wordlist[wordlist.size()-1].length());
-    if (wordlist[wordlist.size()-1].length() > longestWord)
+    if (!validIndex(slots[i].word, header.words))
     {
-      longestWord = wordlist[wordlist.size()-1].length();
+      return false;
     }
   }
+  // a probe runs until it meets an empty slot, so every table needs one
+  for (uint64_t i = 0; i < buckets.size(); i++)
+  {
+    if (buckets[i].bits == 0)
+    {
+      continue;
+    }
+    if (buckets[i].bits < 0 || buckets[i].bits > 30 || buckets[i].offset < 0 ||
+        (uint64_t)buckets[i].offset + (1ULL << buckets[i].bits) > header.hashSlots)
+    {
+      return false;
+    }
+    const HashSlot* first = &slots[buckets[i].offset];
+    if (std::none_of(first, first + (1 << buckets[i].bits), [](const HashSlot& slot) { return slot.word == -1; }))
+    {
+      return false;
+    }
+  }
+
+  wordlist.swap(words);
+  spilled.clear();
+  packed = false;
+  trie.swap(nodes);
+  keys.swap(wordKeys);
+  keyTree.swap(blocks);
+  keyOrder.swap(order);
+  hashBuckets.swap(buckets);
+  hashSlots.swap(slots);
+  std::memcpy(prefix2, data, sizeof(prefix2));
+  std::memcpy(prefix3, data + sizeof(prefix2), sizeof(prefix3));
+  longestWord = header.longestWord;
+  arenas.assign(1, arena);
+  return true;
 }
 
-void Dictionary::printWords(void)
+void Dictionary::printWords(void) const
 {
-  for(int i = 0; i < wordlist.size(); i++)
+  for(int i = 0; i < size(); i++)
   {
-    std::cout << wordlist[i] << std::endl;
+    std::cout << getWord(i) << std::endl;
   }
 }
 
@@ -44,7 +284,7 @@ void Dictionary::selectionSort(void)
     return;
   }
   int current_word = 0;
-  std::string first = wordlist[0], temp;
+  std::string_view first = wordlist[0];
   for (int i = 0; i < wordlist.size(); i++)
   {
     for (int j = i; j < wordlist.size(); j++)
@@ -57,8 +297,11 @@ void Dictionary::selectionSort(void)
     }
     wordlist[current_word] = wordlist[i];
     wordlist[i] = first;
-    first = wordlist[i + 1];
-    current_word = i + 1;
+    if (i + 1 < wordlist.size())
+    {
+      first = wordlist[i + 1];
+      current_word = i + 1;
+    }
   }
 }
 
@@ -73,44 +316,233 @@ void Dictionary::quickSort(void)
   this->quickSort(0,wordlist.size()-1);
 }
 
-int Dictionary::lookupWord(std::string word)
+void Dictionary::heapSort(void) {
+  Heap<std::string_view>::sort(wordlist.begin(), wordlist.end());
+}
+
+// Multikey quicksort: a three-way partition on the character at the
+// current depth, recursing into the equal range one character deeper.
+// Ranges that exceed the recursion budget fall back to introSort.
+void Dictionary::radixSort(void)
+{
+  if (wordlist.size() == 0)
+  {
+    return;
+  }
+  this->radixSort(0, wordlist.size() - 1, 0, depthBudget(wordlist.size()));
+}
+
+// Median-of-three quicksort that switches to heapsort once the recursion
+// budget is spent, so sorted or adversarial input stays O(n log n).
+void Dictionary::introSort(void)
+{
+  if (wordlist.size() == 0)
+  {
+    return;
+  }
+  this->introSort(0, wordlist.size() - 1, depthBudget(wordlist.size()));
+}
+
+// Builds a first-child/next-sibling trie over wordlist. Node 0 is the
+// root; a node's word is the wordlist index ending there, or -1. Call it
+// after sorting so the indices agree with lookupWord.
+void Dictionary::buildIndex(void)
 {
-  int top = wordlist.size();
-  int bottom = 0;
-  int i = top / 2;
-  while (wordlist[i] != word)
+  buildKeys();
+  buildHashes();
+  buildPrefixTables();
+  trie.clear();
+  trie.push_back({0, -1, -1, -1});
+  for (int i = 0; i < wordlist.size(); i++)
   {
-    if(wordlist[i] > word)
+    int node = 0;
+    for (int j = 0; j < wordlist[i].length(); j++)
     {
-      top = i;
+      int next = walk(node, wordlist[i][j]);
+      if (next == -1)
+      {
+        next = trie.size();
+        trie.push_back({wordlist[i][j], -1, trie[node].child, -1});
+        trie[node].child = next;
+      }
+      node = next;
     }
-    if (wordlist[i] < word)
+    if (trie[node].word == -1)
     {
-      bottom = i;
+      trie[node].word = i;
     }
-    if (top - bottom <= 1)
+  }
+}
+
+void Dictionary::buildKeys(void)
+{
+  keys.resize(wordlist.size());
+  for (int i = 0; i < wordlist.size(); i++)
+  {
+    keys[i] = packKey(wordlist[i]);
+  }
+  keyTree.resize((wordlist.size() + KEY_BLOCK - 1) / KEY_BLOCK);
+  keyOrder.assign(keyTree.size() * KEY_BLOCK, wordlist.size());
+  fillKeyTree(0, 0);
+}
+
+// Inexact words are copied into one arena of their own, so the loaded
+// files can go.
+void Dictionary::packWords(void)
+{
+  if (packed || keys.size() != wordlist.size())
+  {
+    return;
+  }
+  size_t textBytes = 0;
+  for (int i = 0; i < wordlist.size(); i++)
+  {
+    if (keys[i] & 1)
     {
-      return -1;
+      spilled.push_back(i);
+      textBytes += wordlist[i].length();
     }
-    i = ((top - bottom) / 2) + bottom;
   }
-  return i;
+  std::shared_ptr<char> arena(new char[textBytes > 0 ? textBytes : 1], std::default_delete<char[]>());
+  std::vector<std::string_view> inexact;
+  inexact.reserve(spilled.size());
+  size_t offset = 0;
+  for (int i = 0; i < spilled.size(); i++)
+  {
+    std::string_view word = wordlist[spilled[i]];
+    std::memcpy(arena.get() + offset, word.data(), word.length());
+    inexact.push_back(std::string_view(arena.get() + offset, word.length()));
+    offset += word.length();
+  }
+  wordlist.swap(inexact);
+  wordlist.shrink_to_fit();
+  spilled.shrink_to_fit();
+  arenas.assign(1, arena);
+  packed = true;
 }
 
-void Dictionary::heapSort(void) {
-  Heap<std::string> maxheap;
-  for (const auto& word: wordlist) {
-    maxheap.insert(word);
+// The views, the index of each spilled word, and the text they see;
+// keys are counted with the index, not here.
+size_t Dictionary::wordBytes(void) const
+{
+  size_t bytes = wordlist.size() * sizeof(std::string_view) + spilled.size() * sizeof(int);
+  for (int i = 0; i < wordlist.size(); i++)
+  {
+    bytes += wordlist[i].length();
   }
-  maxheap.initializeMaxHeapSort();
-  for (int i = wordlist.size() - 1; i > 0; i--) {
-    wordlist[i] = maxheap.getItem(i);
+  return bytes;
+}
+
+// Children are always appended after their parent, so one pass from the
+// last node back sees every child before its parent.
+void Dictionary::countWords(int minLength, std::vector<int>& counts) const
+{
+  counts.assign(trie.size(), 0);
+  for (int node = trie.size() - 1; node >= 0; node--)
+  {
+    int word = trie[node].word;
+    if (word != -1 && (int)getWord(word).length() >= minLength)
+    {
+      counts[node]++;
+    }
+    for (int child = trie[node].child; child != -1; child = trie[child].sibling)
+    {
+      counts[node] += counts[child];
+    }
   }
 }
 
-int Dictionary::getMax(void)
+void Dictionary::buildPrefixTables(void)
 {
-  return longestWord;
+  std::memset(prefix2, 0, sizeof(prefix2));
+  std::memset(prefix3, 0, sizeof(prefix3));
+  for (int i = 0; i < wordlist.size(); i++)
+  {
+    std::string_view word = wordlist[i];
+    if (word.length() >= 2)
+    {
+      int index = letterCode(word[0]) * ALPHABET + letterCode(word[1]);
+      prefix2[index >> 6] |= 1ULL << (index & 63);
+    }
+    if (word.length() >= 3)
+    {
+      int index = (letterCode(word[0]) * ALPHABET + letterCode(word[1])) * ALPHABET + letterCode(word[2]);
+      prefix3[index >> 6] |= 1ULL << (index & 63);
+    }
+  }
+}
+
+// Sizes each length's table to at least twice its word count, so probe
+// chains stay short. Duplicate words keep their first index; they are
+// found by the insert's own probe rather than lookupHashed, so building
+// adds nothing to the lookup statistics.
+void Dictionary::buildHashes(void)
+{
+  std::vector<int> counts(longestWord + 1, 0);
+  for (int i = 0; i < wordlist.size(); i++)
+  {
+    counts[wordlist[i].length()]++;
+  }
+  hashBuckets.assign(longestWord + 1, {0, 0});
+  int total = 0;
+  for (int length = 0; length <= longestWord; length++)
+  {
+    if (counts[length] == 0)
+    {
+      continue;
+    }
+    int bits = 1;
+    while ((1 << bits) < 2 * counts[length])
+    {
+      bits++;
+    }
+    hashBuckets[length] = {total, bits};
+    total += 1 << bits;
+  }
+  hashSlots.assign(total, {0, -1});
+  for (int i = 0; i < wordlist.size(); i++)
+  {
+    uint64_t hash = wordHash(wordlist[i]);
+    const HashBucket& bucket = hashBuckets[wordlist[i].length()];
+    uint32_t mask = (1u << bucket.bits) - 1;
+    uint32_t slot = slotFor(hash, bucket.bits);
+    bool duplicate = false;
+    while (!duplicate && hashSlots[bucket.offset + slot].word != -1)
+    {
+      int word = hashSlots[bucket.offset + slot].word;
+      duplicate = keys[word] == keys[i] && wordlist[word] == wordlist[i];
+      slot = (slot + 1) & mask;
+    }
+    if (!duplicate)
+    {
+      hashSlots[bucket.offset + slot] = {(uint32_t)hash, i};
+    }
+  }
+}
+
+// In-order walk of the tree below block, handing out the sorted keys
+// from index sorted on. Returns the next unused sorted index.
+int Dictionary::fillKeyTree(int sorted, int block)
+{
+  if (block >= keyTree.size())
+  {
+    return sorted;
+  }
+  int first = block * (KEY_BLOCK + 1) + 1;
+  for (int i = 0; i < KEY_BLOCK; i++)
+  {
+    sorted = fillKeyTree(sorted, first + i);
+    if (sorted < keys.size())
+    {
+      keyTree[block].key[i] = keys[sorted];
+      keyOrder[block * KEY_BLOCK + i] = sorted++;
+    }
+    else
+    {
+      keyTree[block].key[i] = UINT64_MAX;
+    }
+  }
+  return fillKeyTree(sorted, first + KEY_BLOCK);
 }
 
 void Dictionary::quickSort(int low, int high)
@@ -128,8 +560,8 @@ void Dictionary::quickSort(int low, int high)
 int Dictionary::partition(int low, int high)
 {
   int i = low;
-  std::string temp;
-  std::string pivotStr = wordlist[high];
+  std::string_view temp;
+  std::string_view pivotStr = wordlist[high];
   for(int j = low; j < high; j++)
   {
     if(wordlist[j] < pivotStr)
@@ -146,9 +578,238 @@ int Dictionary::partition(int low, int high)
   return i;
 }
 
-void convertToLower(char* str, int len)
+void Dictionary::radixSort(int low, int high, int depth, int budget)
+{
+  while (high - low >= SMALL_RANGE)
+  {
+    if (budget == 0)
+    {
+      this->introSort(low, high, depthBudget(high - low + 1));
+      return;
+    }
+    int a = charAt(wordlist[low], depth);
+    int b = charAt(wordlist[low + (high - low) / 2], depth);
+    int c = charAt(wordlist[high], depth);
+    int pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+
+    int lt = low, gt = high, i = low;
+    while (i <= gt)
+    {
+      int letter = charAt(wordlist[i], depth);
+      if (letter < pivot)
+      {
+        std::swap(wordlist[lt++], wordlist[i++]);
+      }
+      else if (letter > pivot)
+      {
+        std::swap(wordlist[i], wordlist[gt--]);
+      }
+      else
+      {
+        i++;
+      }
+    }
+    this->radixSort(low, lt - 1, depth, budget - 1);
+    this->radixSort(gt + 1, high, depth, budget - 1);
+    if (pivot == 0)
+    {
+      // every word in the middle ended at this depth
+      return;
+    }
+    low = lt;
+    high = gt;
+    depth++;
+  }
+  this->insertionSort(low, high);
+}
+
+void Dictionary::introSort(int low, int high, int budget)
+{
+  while (high - low >= SMALL_RANGE)
+  {
+    if (budget == 0)
+    {
+      Heap<std::string_view>::sort(wordlist.begin() + low, wordlist.begin() + high + 1);
+      return;
+    }
+    budget--;
+    int mid = low + (high - low) / 2;
+    if (wordlist[mid] < wordlist[low])
+    {
+      std::swap(wordlist[mid], wordlist[low]);
+    }
+    if (wordlist[high] < wordlist[low])
+    {
+      std::swap(wordlist[high], wordlist[low]);
+    }
+    if (wordlist[high] < wordlist[mid])
+    {
+      std::swap(wordlist[high], wordlist[mid]);
+    }
+    std::string_view pivot = wordlist[mid];
+    int i = low, j = high;
+    while (i <= j)
+    {
+      while (wordlist[i] < pivot)
+      {
+        i++;
+      }
+      while (pivot < wordlist[j])
+      {
+        j--;
+      }
+      if (i <= j)
+      {
+        std::swap(wordlist[i++], wordlist[j--]);
+      }
+    }
+    // recurse into the smaller side, loop on the larger
+    if (j - low < high - i)
+    {
+      this->introSort(low, j, budget);
+      low = i;
+    }
+    else
+    {
+      this->introSort(i, high, budget);
+      high = j;
+    }
+  }
+  this->insertionSort(low, high);
+}
+
+void Dictionary::insertionSort(int low, int high)
+{
+  for (int i = low + 1; i <= high; i++)
+  {
+    std::string_view word = wordlist[i];
+    int j = i - 1;
+    while (j >= low && word < wordlist[j])
+    {
+      wordlist[j + 1] = wordlist[j];
+      j--;
+    }
+    wordlist[j + 1] = word;
+  }
+}
+
+// Character at depth as 1..256, or 0 past the end of the word.
+int charAt(std::string_view word, int depth)
 {
-  for (int i = 0; i < len; i++)
+  if (depth >= word.length())
+  {
+    return 0;
+  }
+  return (unsigned char)word[depth] + 1;
+}
+
+// Recursion allowed before falling back: 2 * log2(n).
+int depthBudget(int n)
+{
+  int budget = 0;
+  while (n > 1)
+  {
+    n >>= 1;
+    budget += 2;
+  }
+  return budget;
+}
+
+template <typename T>
+void writeSection(std::ofstream& outfile, const std::vector<T>& items)
+{
+  outfile.write((const char*)items.data(), items.size() * sizeof(T));
+}
+
+// Copies count items out of the file, which need not be aligned for T,
+// and returns where the next section starts.
+template <typename T>
+const char* readSection(const char* data, std::vector<T>& items, uint64_t count)
+{
+  items.resize(count);
+  std::memcpy((void*)items.data(), data, count * sizeof(T));
+  return data + count * sizeof(T);
+}
+
+// -1, or an index below limit
+bool validIndex(int index, uint64_t limit)
+{
+  return index == -1 || (index >= 0 && (uint64_t)index < limit);
+}
+
+// Maps the file copy-on-write where mmap exists, so lowercasing in place
+// never touches the file; otherwise reads it into a heap buffer.
+std::shared_ptr<char> loadFile(const std::string& filename, size_t& length)
+{
+#if defined(__unix__) || defined(__APPLE__)
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    return nullptr;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size == 0)
+  {
+    close(fd);
+    return nullptr;
+  }
+  length = info.st_size;
+  void* data = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+  {
+    return nullptr;
+  }
+  return std::shared_ptr<char>((char*)data, [length](char* p) { munmap(p, length); });
+#else
+  std::ifstream infile(filename, std::ios::binary | std::ios::ate);
+  if (!infile || infile.tellg() <= 0)
+  {
+    return nullptr;
+  }
+  length = infile.tellg();
+  std::shared_ptr<char> data(new char[length], std::default_delete<char[]>());
+  infile.seekg(0);
+  infile.read(data.get(), length);
+  return data;
+#endif
+}
+
+// Folds A-Z a register at a time (AVX2, else SSE2): bytes inside the
+// range get 0x20 or'd in. Blocks without capitals are not written back,
+// which keeps untouched pages of a mapped file shared. The scalar loop
+// finishes the tail.
+void convertToLower(char* str, size_t len)
+{
+  size_t i = 0;
+#if defined(__AVX2__)
+  const __m256i below = _mm256_set1_epi8('A' - 1);
+  const __m256i above = _mm256_set1_epi8('Z' + 1);
+  const __m256i bit = _mm256_set1_epi8(0x20);
+  for (; i + 32 <= len; i += 32)
+  {
+    __m256i block = _mm256_loadu_si256((const __m256i*)(str + i));
+    __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(block, below), _mm256_cmpgt_epi8(above, block));
+    if (_mm256_movemask_epi8(upper) != 0)
+    {
+      _mm256_storeu_si256((__m256i*)(str + i), _mm256_or_si256(block, _mm256_and_si256(upper, bit)));
+    }
+  }
+#elif defined(__SSE2__)
+  const __m128i below = _mm_set1_epi8('A' - 1);
+  const __m128i above = _mm_set1_epi8('Z' + 1);
+  const __m128i bit = _mm_set1_epi8(0x20);
+  for (; i + 16 <= len; i += 16)
+  {
+    __m128i block = _mm_loadu_si128((const __m128i*)(str + i));
+    __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(block, below), _mm_cmpgt_epi8(above, block));
+    if (_mm_movemask_epi8(upper) != 0)
+    {
+      _mm_storeu_si128((__m128i*)(str + i), _mm_or_si128(block, _mm_and_si128(upper, bit)));
+    }
+  }
+#endif
+  for (; i < len; i++)
   {
     if (str[i] >= 'A' && str[i] <= 'Z')
     {
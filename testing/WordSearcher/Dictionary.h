@@ -1,5 +1,11 @@
 #include <vector>
 #include <iostream>
+#include <memory>
+#include <string_view>
+#include <cstdint>
+#include <string>
+#include <algorithm>
+#include "Stats.h"
 
 #ifndef DICTIONARY_H
 #define DICTIONARY_H
@@ -9,17 +15,344 @@ class Dictionary
 public:
   Dictionary(void);
   void readWords(std::string filename);
-  void printWords(void);
+  // precompiled form: the sorted words and their prefix index
+  bool saveBinary(std::string filename) const;
+  bool loadBinary(std::string filename);
+  void printWords(void) const;
   void selectionSort(void);
   void quickSort(void);
-  int lookupWord(std::string word);
-  int getMax(void);
+  inline int lookupWord(std::string_view word) const;
+  int getMax(void) const { return longestWord; }
+  int size(void) const { return packed ? keys.size() : wordlist.size(); }
+  // a copy, since packed words have no text to view; words of up to
+  // KEY_LETTERS letters fit the string without allocating
+  inline std::string getWord(int index) const;
   void heapSort(void);
+  void radixSort(void);
+  void introSort(void);
+  // prefix index and lookup keys, built from the current wordlist order
+  void buildIndex(void);
+  // Encoded mode, after buildIndex: words whose key is exact keep only
+  // the key, and getWord decodes them. The rest keep their text in a
+  // new arena and the loaded files are released. Sorting or indexing
+  // again is not supported afterwards; loadBinary starts over.
+  void packWords(void);
+  // bytes held for word text and the views into it
+  size_t wordBytes(void) const;
+  int indexRoot(void) const { return 0; }
+  inline int walk(int node, char letter) const;
+  int nodeWord(int node) const { return trie[node].word; }
+  // per prefix node, how many words of at least minLength end at or
+  // below it
+  void countWords(int minLength, std::vector<int>& counts) const;
+  // Words as 5-bit letter codes, up to KEY_LETTERS of them in one
+  // integer whose order is the word order. Bit 0 is clear when the key
+  // is the whole word (at most KEY_LETTERS letters, all a-z), so equal
+  // keys mean equal words; otherwise the text has to confirm.
+  // extendKey adds the letter at position, packKey a whole word.
+  static const int KEY_LETTERS = 12;
+  static inline uint64_t extendKey(uint64_t key, int position, char letter);
+  static inline uint64_t packKey(std::string_view word);
+  // exact lookup through per-length hash tables; hash and key are
+  // wordHash(word) and packKey(word), which a caller extending a string
+  // one letter at a time can keep with extendHash and extendKey
+  static uint64_t extendHash(uint64_t hash, char letter) { return hash * HASH_BASE + (unsigned char)letter + 1; }
+  static inline uint64_t wordHash(std::string_view word);
+  inline int lookupHashed(std::string_view word, uint64_t hash, uint64_t key) const;
+  // false when no word of at least 2 (3) letters starts with the first
+  // 2 (3) of letters; one bit test
+  bool startsWord2(const char* letters) const { return testBit(prefix2, letterCode(letters[0]) * ALPHABET + letterCode(letters[1])); }
+  bool startsWord3(const char* letters) const { return testBit(prefix3, (letterCode(letters[0]) * ALPHABET + letterCode(letters[1])) * ALPHABET + letterCode(letters[2])); }
 private:
+  // a-z, and one code shared by every other byte
+  static const int ALPHABET = 27;
+  static int letterCode(char letter) { unsigned code = (unsigned char)letter - 'a'; return code < 26 ? code : 26; }
+  static bool testBit(const uint64_t* bits, int index) { return bits[index >> 6] >> (index & 63) & 1; }
+  static const uint64_t HASH_BASE = 0x100000001b3ULL;
+  // multiply-shift: the top bits of hash times a 64-bit odd constant
+  static uint32_t slotFor(uint64_t hash, int bits) { return (hash * 0x9e3779b97f4a7c15ULL) >> (64 - bits); }
+  struct HashSlot
+  {
+    uint32_t tag;
+    int word;
+  };
+  struct HashBucket
+  {
+    int offset;
+    int bits;
+  };
+  // keys per node of the lookup tree, one cache line
+  static const int KEY_BLOCK = 8;
+  struct alignas(64) KeyBlock
+  {
+    uint64_t key[KEY_BLOCK];
+  };
+  struct TrieNode
+  {
+    char letter;
+    int child;
+    int sibling;
+    int word;
+  };
   void quickSort(int low, int high);
   int partition(int low, int high);
-  std::vector<std::string> wordlist;
+  void radixSort(int low, int high, int depth, int budget);
+  void introSort(int low, int high, int budget);
+  void insertionSort(int low, int high);
+  void buildKeys(void);
+  void buildHashes(void);
+  void buildPrefixTables(void);
+  int fillKeyTree(int sorted, int block);
+  inline int lowerBound(uint64_t key) const;
+  inline int compareAt(int index, uint64_t key, std::string_view word) const;
+  // the text of word index, which once packed only inexact keys have
+  inline std::string_view textAt(int index) const;
+  // words are views into the loaded files; arenas owns that memory and
+  // is shared between copies. Once packed, wordlist holds only the
+  // inexact words and spilled their indices, ascending
+  std::vector<std::string_view> wordlist;
+  std::vector<std::shared_ptr<char>> arenas;
+  std::vector<int> spilled;
+  bool packed;
+  std::vector<TrieNode> trie;
+  // packKey of each word, so most lookup probes are one integer compare
+  std::vector<uint64_t> keys;
+  // the same keys as an implicit B-tree: block b has children
+  // b * (KEY_BLOCK + 1) + 1 + i. keyOrder is the wordlist index of each
+  // slot; padding slots hold UINT64_MAX
+  std::vector<KeyBlock> keyTree;
+  std::vector<int> keyOrder;
+  // open-addressed table per word length, 2^bits slots from offset in
+  // hashSlots, linear probing; empty slots have word -1
+  std::vector<HashBucket> hashBuckets;
+  std::vector<HashSlot> hashSlots;
+  // bit per 2- and 3-letter word prefix, in letterCode digits
+  uint64_t prefix2[(ALPHABET * ALPHABET + 63) / 64];
+  uint64_t prefix3[(ALPHABET * ALPHABET * ALPHABET + 63) / 64];
   int longestWord;
 };
 
+// Returns the index of word in the sorted wordlist, or -1. With the
+// index built, the key tree finds the first word sharing the key; an
+// exact key is the answer, an inexact one scans the run of equal keys.
+int Dictionary::lookupWord(std::string_view word) const
+{
+  uint64_t key = packKey(word);
+  int bottom = 0;
+  int top = size();
+  STATS_ADD(lookups, 1);
+  if ((int)keys.size() == top && !keyTree.empty())
+  {
+    int slot = lowerBound(key);
+    if (slot == -1 || keyTree[slot / KEY_BLOCK].key[slot % KEY_BLOCK] != key)
+    {
+      return -1;
+    }
+    if (!(key & 1))
+    {
+      return keyOrder[slot];
+    }
+    for (int i = keyOrder[slot]; i < top && keys[i] == key; i++)
+    {
+      int order = compareAt(i, key, word);
+      STATS_ADD(probes, 1);
+      if (order == 0)
+      {
+        return i;
+      }
+      if (order > 0)
+      {
+        break;
+      }
+    }
+    return -1;
+  }
+  while (bottom < top)
+  {
+    int i = bottom + (top - bottom) / 2;
+    int order = compareAt(i, key, word);
+    STATS_ADD(probes, 1);
+    if (order == 0)
+    {
+      return i;
+    }
+    if (order < 0)
+    {
+      bottom = i + 1;
+    }
+    else
+    {
+      top = i;
+    }
+  }
+  return -1;
+}
+
+// Slot of the first key not below key, or -1 if every key is below it.
+// One cache line per level; the children of a block are adjacent, so
+// they are prefetched while the block is ranked.
+int Dictionary::lowerBound(uint64_t key) const
+{
+  int blocks = keyTree.size();
+  int slot = -1;
+  int block = 0;
+  while (block < blocks)
+  {
+    int first = block * (KEY_BLOCK + 1) + 1;
+#if defined(__GNUC__)
+    if (first < blocks)
+    {
+      __builtin_prefetch(&keyTree[first]);
+      __builtin_prefetch(&keyTree[first] + KEY_BLOCK / 2);
+    }
+#endif
+    int rank = 0;
+    for (int i = 0; i < KEY_BLOCK; i++)
+    {
+      rank += keyTree[block].key[i] < key;
+    }
+    STATS_ADD(probes, 1);
+    if (rank < KEY_BLOCK)
+    {
+      slot = block * KEY_BLOCK + rank;
+    }
+    block = first + rank;
+  }
+  return slot;
+}
+
+uint64_t Dictionary::wordHash(std::string_view word)
+{
+  uint64_t hash = 0;
+  for (int i = 0; i < word.length(); i++)
+  {
+    hash = extendHash(hash, word[i]);
+  }
+  return hash;
+}
+
+// Usually one probe: the slot the hash maps to holds the word or is
+// empty. Slots whose tag matches are confirmed by the word's key, and by
+// its text when the key is inexact.
+int Dictionary::lookupHashed(std::string_view word, uint64_t hash, uint64_t key) const
+{
+  STATS_ADD(lookups, 1);
+  if (word.length() >= hashBuckets.size())
+  {
+    return -1;
+  }
+  const HashBucket& bucket = hashBuckets[word.length()];
+  if (bucket.bits == 0)
+  {
+    return -1;
+  }
+  uint32_t mask = (1u << bucket.bits) - 1;
+  uint32_t i = slotFor(hash, bucket.bits);
+  for (;; i = (i + 1) & mask)
+  {
+    const HashSlot& slot = hashSlots[bucket.offset + i];
+    STATS_ADD(probes, 1);
+    if (slot.word == -1)
+    {
+      return -1;
+    }
+    if (slot.tag == (uint32_t)hash && keys[slot.word] == key && (!(key & 1) || textAt(slot.word) == word))
+    {
+      return slot.word;
+    }
+  }
+}
+
+// Codes from the top bits down: 0 past the end, 1 for bytes below 'a',
+// 2-27 for a-z, 28 for bytes above 'z'. The two catch-all codes stand
+// for many bytes, so the key stops after one of them; keys then still
+// never order two words the wrong way round.
+uint64_t Dictionary::extendKey(uint64_t key, int position, char letter)
+{
+  if ((key & 1) || position >= KEY_LETTERS)
+  {
+    return key | 1;
+  }
+  unsigned char byte = letter;
+  uint64_t code = byte < 'a' ? 1 : (byte > 'z' ? 28 : byte - 'a' + 2);
+  key |= code << (59 - 5 * position);
+  return code == 1 || code == 28 ? key | 1 : key;
+}
+
+uint64_t Dictionary::packKey(std::string_view word)
+{
+  uint64_t key = 0;
+  int length = word.length() <= KEY_LETTERS ? word.length() : KEY_LETTERS + 1;
+  for (int i = 0; i < length; i++)
+  {
+    key = extendKey(key, i, word[i]);
+  }
+  return key;
+}
+
+// Orders wordlist[index] against word. Different keys decide at once,
+// equal exact keys are the same word, and only equal inexact keys need
+// the text.
+int Dictionary::compareAt(int index, uint64_t key, std::string_view word) const
+{
+  if ((int)keys.size() != size())
+  {
+    return wordlist[index].compare(word);
+  }
+  if (keys[index] != key)
+  {
+    return keys[index] < key ? -1 : 1;
+  }
+  if (!(key & 1))
+  {
+    return 0;
+  }
+  return textAt(index).compare(word);
+}
+
+std::string_view Dictionary::textAt(int index) const
+{
+  if (!packed)
+  {
+    return wordlist[index];
+  }
+  return wordlist[std::lower_bound(spilled.begin(), spilled.end(), index) - spilled.begin()];
+}
+
+// An exact key spells the word: letter codes from the top until the
+// first 0.
+std::string Dictionary::getWord(int index) const
+{
+  if (!packed || (keys[index] & 1))
+  {
+    return std::string(textAt(index));
+  }
+  char text[KEY_LETTERS];
+  int length = 0;
+  for (; length < KEY_LETTERS; length++)
+  {
+    int code = keys[index] >> (59 - 5 * length) & 31;
+    if (code == 0)
+    {
+      break;
+    }
+    text[length] = 'a' + code - 2;
+  }
+  return std::string(text, length);
+}
+
+// Returns the child of node reached by letter, or -1 once no word in the
+// dictionary continues the prefix.
+int Dictionary::walk(int node, char letter) const
+{
+  for (int i = trie[node].child; i != -1; i = trie[i].sibling)
+  {
+    if (trie[i].letter == letter)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
 #endif //DICTIONARY_H
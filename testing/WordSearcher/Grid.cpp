@@ -2,53 +2,301 @@
 #include <iostream>
 #include <vector>
 #include <fstream>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+const int Grid::ROW_STEP[Grid::DIRECTIONS] = {-1, -1, -1, 0, 0, 1, 1, 1};
+const int Grid::COL_STEP[Grid::DIRECTIONS] = {-1, 0, 1, -1, 1, -1, 0, 1};
+// 0 rows, 1 columns, 2 diagonals, 3 anti-diagonals
+const int Grid::FAMILY[Grid::DIRECTIONS] = {2, 1, 3, 0, 0, 3, 1, 2};
+const int Grid::FORWARD[4] = {4, 6, 7, 5};
+const int Grid::BACKWARD[4] = {3, 1, 0, 2};
+
+/******* PRIVATE FUNCTION DECLARATIONS *********/
+
+int gcd(int a, int b);
+
+// read size for GridReader
+const size_t READ_BLOCK = 1 << 16;
 
 Grid::Grid(std::string filename)
 {
-  int width, height;
-  std::ifstream infile(filename);
-  char inchar;
-  letters = {};
-  infile >> width;
-  infile >> height;
-  for(int i = 0; i < width; i++)
+  GridReader reader(filename);
+  width = reader.getWidth();
+  height = reader.getHeight();
+  rayLength = 0;
+  diagonals = 1;
+  letters.resize(width * height);
+  for (int row = 0; row < height; row++)
   {
-    letters.push_back({});
-    for(int j = 0; j < height; j++)
+    if (!reader.readRow(&letters[row * width]))
     {
-      infile >> inchar;
-      letters[i].push_back(inchar);
+      break;
     }
   }
 }
 
-int Grid::getWidth(void)
+Grid::Grid(std::istream& in)
 {
-  return letters.size();
+  char inchar = 0;
+  width = 0;
+  height = 0;
+  rayLength = 0;
+  diagonals = 1;
+  in >> width;
+  in >> height;
+  if (!in || width <= 0 || height <= 0)
+  {
+    width = height = 0;
+    return;
+  }
+  letters.reserve(width * height);
+  for(int i = 0; i < width * height; i++)
+  {
+    if (!(in >> inchar))
+    {
+      letters.clear();
+      width = height = 0;
+      return;
+    }
+    letters.push_back(inchar);
+  }
 }
 
-int Grid::getHeight(void)
+Grid::Grid(const char* letters, int width, int height) : width(width), height(height), letters(letters, letters + width * height)
 {
-  return letters[0].size();
+  rayLength = 0;
+  diagonals = 1;
 }
 
-char Grid::getLetter(int col, int row)
+void Grid::printGrid(void) const
 {
-  if (letters.size() <= col || letters[0].size() <= row)
+  for(int row = 0; row < height; row++)
   {
-    return -1;
+    for(int col = 0; col < width; col++)
+    {
+      std::cout << letters[row * width + col] << " ";
+    }
+    std::cout << std::endl;
   }
-  return letters[col][row];
 }
 
-void Grid::printGrid(void)
+// A line of length n appears at positions pos, pos + n, ... of its
+// forward section and n - 1 - pos, 2n - 1 - pos, ... of the reversed one.
+void Grid::setLetter(int col, int row, char letter)
 {
-  for(int i = 0; i < letters.size(); i++)
+  if (col < 0 || row < 0 || width <= col || height <= row)
+  {
+    return;
+  }
+  letters[row * width + col] = letter;
+  if (rays.empty())
   {
-    for(int j = 0; j < letters[0].size(); j++)
+    return;
+  }
+  for (int f = 0; f < 4; f++)
+  {
+    int line, pos;
+    linePosition(col, row, f, line, pos);
+    int stride = lineLength[f] + rayLength - 1;
+    char* fwd = &rays[rayBase[FORWARD[f]] + line * stride];
+    char* rev = &rays[rayBase[BACKWARD[f]] + line * stride];
+    for (int k = pos; k < stride; k += lineLength[f])
     {
-      std::cout << letters[i][j] << " ";
+      fwd[k] = letter;
     }
-    std::cout << std::endl;
+    for (int k = lineLength[f] - 1 - pos; k < stride; k += lineLength[f])
+    {
+      rev[k] = letter;
+    }
+  }
+}
+
+void Grid::buildRays(int length)
+{
+  // FORWARD directions are stored as is; the other four read the
+  // reversed sections
+  int lineCount[4];
+
+  rayLength = length < 1 ? 1 : length;
+  if (width == 0 || height == 0)
+  {
+    return;
+  }
+  diagonals = gcd(width, height);
+  lineCount[0] = height;
+  lineLength[0] = width;
+  lineCount[1] = width;
+  lineLength[1] = height;
+  lineCount[2] = lineCount[3] = diagonals;
+  lineLength[2] = lineLength[3] = width / diagonals * height;
+
+  rays.clear();
+  diagonalPos.assign(2 * width * height, 0);
+  std::vector<char> line;
+  for (int f = 0; f < 4; f++)
+  {
+    int stride = lineLength[f] + rayLength - 1;
+    rayBase[FORWARD[f]] = rays.size();
+    rayBase[BACKWARD[f]] = rays.size() + lineCount[f] * stride;
+    rays.resize(rays.size() + 2 * lineCount[f] * stride);
+    for (int l = 0; l < lineCount[f]; l++)
+    {
+      line.clear();
+      for (int k = 0; k < lineLength[f]; k++)
+      {
+        int col, row;
+        getLineCell(FORWARD[f], l, k, col, row);
+        if (f >= 2)
+        {
+          diagonalPos[(f - 2) * width * height + row * width + col] = k;
+        }
+        line.push_back(letters[row * width + col]);
+      }
+      char* fwd = &rays[rayBase[FORWARD[f]] + l * stride];
+      char* rev = &rays[rayBase[BACKWARD[f]] + l * stride];
+      for (int k = 0; k < stride; k++)
+      {
+        fwd[k] = line[k % lineLength[f]];
+        rev[k] = line[lineLength[f] - 1 - k % lineLength[f]];
+      }
+    }
+  }
+}
+
+int Grid::getLineCount(int direction) const
+{
+  int f = FAMILY[direction];
+  if (rays.empty())
+  {
+    return 0;
+  }
+  return f == 0 ? height : (f == 1 ? width : diagonals);
+}
+
+int Grid::getLineLength(int direction) const
+{
+  return lineLength[FAMILY[direction]];
+}
+
+const char* Grid::getLine(int direction, int line) const
+{
+  return &rays[rayBase[direction] + line * (getLineLength(direction) + rayLength - 1)];
+}
+
+// Maps position pos of a line returned by getLine back to its grid cell.
+void Grid::getLineCell(int direction, int line, int pos, int& col, int& row) const
+{
+  int f = FAMILY[direction];
+  if (ROW_STEP[direction] < 0 || (ROW_STEP[direction] == 0 && COL_STEP[direction] < 0))
+  {
+    pos = lineLength[f] - 1 - pos;
+  }
+  row = f == 1 ? pos : (f == 0 ? line : pos % height);
+  col = f == 0 ? pos : (f == 1 ? line : (f == 2 ? (line + pos) % width : ((line - pos) % width + width) % width));
+}
+
+GridReader::GridReader(std::string filename) : infile(filename, std::ios::binary), buffer(READ_BLOCK)
+{
+  pos = end = 0;
+  width = readNumber();
+  height = readNumber();
+  if (width <= 0 || height <= 0)
+  {
+    width = height = 0;
+  }
+}
+
+bool GridReader::fill(void)
+{
+  pos = 0;
+  end = 0;
+  if (infile)
+  {
+    infile.read(buffer.data(), buffer.size());
+    end = infile.gcount();
+  }
+  return end > 0;
+}
+
+int GridReader::readNumber(void)
+{
+  int value = 0;
+  while ((pos < end || fill()) && (unsigned char)buffer[pos] <= ' ')
+  {
+    pos++;
+  }
+  while ((pos < end || fill()) && buffer[pos] >= '0' && buffer[pos] <= '9')
+  {
+    value = value * 10 + (buffer[pos++] - '0');
+  }
+  return value;
+}
+
+// Each 16 byte block is classified by which bytes are letters. A block
+// of letters is copied whole, and a block of letters alternating with
+// single spaces or line ends (the usual grid file, in either phase) is
+// packed to its 8 letters. Anything else goes through a branchless
+// compaction that writes every byte and only advances past letters.
+bool GridReader::readRow(char* row)
+{
+  int n = 0;
+  while (n < width)
+  {
+    if (pos == end && !fill())
+    {
+      return false;
+    }
+#ifdef __SSE2__
+    while (end - pos >= 16 && width - n >= 8)
+    {
+      __m128i block = _mm_loadu_si128((const __m128i*)&buffer[pos]);
+      // unsigned compare, as in the scalar loop: a byte is a letter when
+      // max(byte, '!') leaves it unchanged
+      int letters = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(block, _mm_set1_epi8('!')), block));
+      if (letters == 0x5555)
+      {
+        block = _mm_and_si128(block, _mm_set1_epi16(0x00FF));
+      }
+      else if (letters == 0xAAAA)
+      {
+        block = _mm_srli_epi16(block, 8);
+      }
+      else if (letters == 0xFFFF && width - n >= 16)
+      {
+        _mm_storeu_si128((__m128i*)(row + n), block);
+        pos += 16;
+        n += 16;
+        continue;
+      }
+      else
+      {
+        break;
+      }
+      _mm_storel_epi64((__m128i*)(row + n), _mm_packus_epi16(block, block));
+      pos += 16;
+      n += 8;
+    }
+#endif
+    size_t stop = pos + (width - n < end - pos ? width - n : end - pos);
+    while (pos < stop)
+    {
+      char c = buffer[pos++];
+      row[n] = c;
+      n += (unsigned char)c > ' ';
+    }
+  }
+  return true;
+}
+
+int gcd(int a, int b)
+{
+  while (b != 0)
+  {
+    int t = a % b;
+    a = b;
+    b = t;
   }
+  return a;
 }
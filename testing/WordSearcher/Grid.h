@@ -1,19 +1,138 @@
 #include <vector>
 #include <iostream>
+#include <fstream>
+#include <climits>
 
 #ifndef GRID_H
 #define GRID_H
 
+// Buffered reader for grid files: the "width height" header, then the
+// letters one row at a time with whitespace skipped in bulk.
+class GridReader
+{
+public:
+  GridReader(std::string filename);
+  int getWidth(void) const { return width; }
+  int getHeight(void) const { return height; }
+  // copies the next getWidth() letters into row; false once the file ends
+  bool readRow(char* row);
+private:
+  bool fill(void);
+  int readNumber(void);
+  std::ifstream infile;
+  std::vector<char> buffer;
+  size_t pos;
+  size_t end;
+  int width;
+  int height;
+};
+
 class Grid
 {
 public:
   Grid(std::string filename);
-  int getWidth(void);
-  int getHeight(void);
-  char getLetter(int col, int row);
-  void printGrid(void);
+  // reads "width height" and then the letters from a stream; empty if
+  // either runs short
+  Grid(std::istream& in);
+  // copies width * height row-major letters
+  Grid(const char* letters, int width, int height);
+  int getWidth(void) const { return width; }
+  int getHeight(void) const { return height; }
+  inline char getLetter(int col, int row) const;
+  // also rewrites every copy of the cell in the ray buffers; cells
+  // outside the grid are ignored
+  void setLetter(int col, int row, char letter);
+  // row-major letters, one row every getWidth() chars
+  const char* getRow(int row) const { return &letters[row * width]; }
+  void printGrid(void) const;
+  // toroidal rays in the 8 directions, materialized once per line
+  void buildRays(int length);
+  int getRayLength(void) const { return rayLength; }
+  inline const char* getRay(int col, int row, int direction) const;
+  // cells from (col, row) to the edge in direction, the start included
+  inline int getEdgeDistance(int col, int row, int direction) const;
+  // whole lines behind the rays: getLineLength(direction) letters plus
+  // getRayLength() - 1 wrapped ones
+  int getLineCount(int direction) const;
+  int getLineLength(int direction) const;
+  const char* getLine(int direction, int line) const;
+  void getLineCell(int direction, int line, int pos, int& col, int& row) const;
+  static const int DIRECTIONS = 8;
+  static const int ROW_STEP[DIRECTIONS];
+  static const int COL_STEP[DIRECTIONS];
 private:
-  std::vector<std::vector<char>> letters;
+  static const int FAMILY[DIRECTIONS];
+  // per line family, the direction stored forward and the reversed one
+  static const int FORWARD[4];
+  static const int BACKWARD[4];
+  inline void linePosition(int col, int row, int family, int& line, int& pos) const;
+  int width;
+  int height;
+  std::vector<char> letters;
+  // rays: for each line family (rows, columns, diagonals, anti-diagonals)
+  // a forward and a reversed section; each line is stored once, followed
+  // by its first rayLength - 1 letters again so no ray has to wrap
+  int rayLength;
+  int diagonals;
+  int lineLength[4];
+  int rayBase[DIRECTIONS];
+  std::vector<char> rays;
+  std::vector<int> diagonalPos;
 };
 
+char Grid::getLetter(int col, int row) const
+{
+  if (col < 0 || row < 0 || width <= col || height <= row)
+  {
+    return -1;
+  }
+  return letters[row * width + col];
+}
+
+// Returns getRayLength() letters starting at (col, row) and stepping in
+// direction, wrapping around the edges. buildRays must have been called.
+const char* Grid::getRay(int col, int row, int direction) const
+{
+  int f = FAMILY[direction];
+  int line, pos;
+  linePosition(col, row, f, line, pos);
+  if (ROW_STEP[direction] < 0 || (ROW_STEP[direction] == 0 && COL_STEP[direction] < 0))
+  {
+    pos = lineLength[f] - 1 - pos;
+  }
+  return &rays[rayBase[direction] + line * (lineLength[f] + rayLength - 1) + pos];
+}
+
+// The line through (col, row) in a family and the cell's position along
+// it in the forward direction.
+void Grid::linePosition(int col, int row, int family, int& line, int& pos) const
+{
+  switch (family)
+  {
+    case 0:
+      line = row;
+      pos = col;
+      break;
+    case 1:
+      line = col;
+      pos = row;
+      break;
+    case 2:
+      line = ((col - row) % diagonals + diagonals) % diagonals;
+      pos = diagonalPos[row * width + col];
+      break;
+    default:
+      line = (col + row) % diagonals;
+      pos = diagonalPos[width * height + row * width + col];
+      break;
+  }
+}
+
+int Grid::getEdgeDistance(int col, int row, int direction) const
+{
+  int rows = ROW_STEP[direction] < 0 ? row + 1 : ROW_STEP[direction] > 0 ? height - row : INT_MAX;
+  int cols = COL_STEP[direction] < 0 ? col + 1 : COL_STEP[direction] > 0 ? width - col : INT_MAX;
+  return rows < cols ? rows : cols;
+}
+
 #endif //GRID_H
@@ -1,18 +1,96 @@
 #include <vector>
+#include <functional>
+#include <utility>
 
-template <typename T>
+#ifndef HEAP_H
+#define HEAP_H
+
+// Binary max-heap under Compare (the top is the element no other compares
+// greater than), usable as a priority queue. With std::greater the top is
+// the smallest item, so a heap popped whenever it grows past K keeps the
+// K largest items. Heap::sort heapsorts a caller's range in place.
+template <typename T, typename Compare = std::less<T>>
 class Heap {
 public:
-    void initializeMaxHeapSort();
-    T getItem(int i);
-    void insert(T value);
-    int size();
+    Heap(Compare compare = Compare()) : compare(compare) {}
+    void push(const T& value);
+    void push(T&& value);
+    void pop();
+    const T& top() const { return item_list[0]; }
+    void reserve(int n) { item_list.reserve(n); }
+    int size() const { return item_list.size(); }
+    bool empty() const { return item_list.empty(); }
+    template <typename Iterator>
+    static void sort(Iterator first, Iterator last, Compare compare = Compare());
 private:
     std::vector<T> item_list;
-    int parent(int i);
-    int child_left(int i);
-    int child_right(int i);
-    void maxHeapify(int size, int i);
-    void maxHeapSort();
+    Compare compare;
+    static int parent(int i) { return (i - 1) / 2; }
+    static int child_left(int i) { return 2 * i + 1; }
+    static int child_right(int i) { return 2 * i + 2; }
+    void siftUp(int i);
+    template <typename Iterator>
+    static void siftDown(Iterator first, int size, int i, Compare& compare);
 };
 
+template <typename T, typename Compare>
+void Heap<T, Compare>::push(const T& value) {
+    item_list.push_back(value);
+    siftUp(item_list.size() - 1);
+}
+
+template <typename T, typename Compare>
+void Heap<T, Compare>::push(T&& value) {
+    item_list.push_back(std::move(value));
+    siftUp(item_list.size() - 1);
+}
+
+template <typename T, typename Compare>
+void Heap<T, Compare>::pop() {
+    item_list[0] = std::move(item_list.back());
+    item_list.pop_back();
+    if (!item_list.empty()) {
+        siftDown(item_list.begin(), item_list.size(), 0, compare);
+    }
+}
+
+template <typename T, typename Compare>
+template <typename Iterator>
+void Heap<T, Compare>::sort(Iterator first, Iterator last, Compare compare) {
+    int N = last - first;
+    for (int i = N / 2 - 1; i >= 0; i--)
+        siftDown(first, N, i, compare);
+    for (int i = N - 1; i > 0; i--) {
+        std::swap(first[0], first[i]);
+        siftDown(first, i, 0, compare);
+    }
+}
+
+template <typename T, typename Compare>
+void Heap<T, Compare>::siftUp(int i) {
+    T value = std::move(item_list[i]);
+    while (i > 0 && compare(item_list[parent(i)], value)) {
+        item_list[i] = std::move(item_list[parent(i)]);
+        i = parent(i);
+    }
+    item_list[i] = std::move(value);
+}
+
+// Moves first[i] down until neither child compares greater; the hole is
+// filled from below so each level costs one move instead of a swap.
+template <typename T, typename Compare>
+template <typename Iterator>
+void Heap<T, Compare>::siftDown(Iterator first, int size, int i, Compare& compare) {
+    T value = std::move(first[i]);
+    while (child_left(i) < size) {
+        int largest = child_left(i);
+        int r = child_right(i);
+        if (r < size && compare(first[largest], first[r])) { largest = r; }
+        if (!compare(value, first[largest])) { break; }
+        first[i] = std::move(first[largest]);
+        i = largest;
+    }
+    first[i] = std::move(value);
+}
+
+#endif //HEAP_H
@@ -0,0 +1,148 @@
+#include "Incremental.h"
+#include "Search.h"
+#include <vector>
+#include <map>
+#include <algorithm>
+
+// Searched with dedup off: which occurrence of a word comes first can
+// change with any edit, so getMatches dedups on the way out.
+IncrementalSolver::IncrementalSolver(const WordSearcher& searcher, Grid grid) : searcher(searcher), grid(std::move(grid))
+{
+  const Dictionary& dict = searcher.getDictionary();
+  SearchOptions options = searcher.getOptions();
+  options.dedup = DEDUP_OFF;
+  if (options.engine == ENGINE_AHO_CORASICK)
+  {
+    options.engine = ENGINE_TRIE;
+  }
+  if (this->grid.getRayLength() < dict.getMax())
+  {
+    this->grid.buildRays(dict.getMax());
+  }
+  std::vector<Match> matches = findMatches(dict, this->grid, options);
+  for (int i = 0; i < matches.size(); i++)
+  {
+    rays[rayKey(matches[i].col, matches[i].row, matches[i].direction)].push_back(matches[i]);
+  }
+}
+
+// A ray starting k cells before (col, row) covers it when k is below
+// the ray length; without wrap, starts past the edge do not exist.
+void IncrementalSolver::setLetter(int col, int row, char letter)
+{
+  const SearchOptions& options = searcher.getOptions();
+  int width = grid.getWidth(), height = grid.getHeight();
+  removed.clear();
+  added.clear();
+  if (col < 0 || row < 0 || width <= col || height <= row)
+  {
+    return;
+  }
+  grid.setLetter(col, row, letter);
+
+  std::vector<int> keys;
+  for (int direction = 0; direction < Grid::DIRECTIONS; direction++)
+  {
+    if (!(options.directions >> direction & 1))
+    {
+      continue;
+    }
+    int r = row, c = col;
+    for (int k = 0; k < grid.getRayLength(); k++)
+    {
+      keys.push_back(rayKey(c, r, direction));
+      r -= Grid::ROW_STEP[direction];
+      c -= Grid::COL_STEP[direction];
+      if (r < 0 || r >= height || c < 0 || c >= width)
+      {
+        if (!options.wrap)
+        {
+          break;
+        }
+        r = (r + height) % height;
+        c = (c + width) % width;
+      }
+    }
+  }
+  // on grids smaller than a ray, the same start comes round again
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+  std::vector<Match> fresh;
+  for (int i = 0; i < keys.size(); i++)
+  {
+    fresh.clear();
+    searchRay(keys[i], fresh);
+    auto found = rays.find(keys[i]);
+    std::vector<Match> none;
+    const std::vector<Match>& stale = found == rays.end() ? none : found->second;
+    // both lists are in length order, at most one match per length
+    int a = 0, b = 0;
+    while (a < stale.size() || b < fresh.size())
+    {
+      if (b == fresh.size() || (a < stale.size() && stale[a].length < fresh[b].length))
+      {
+        removed.push_back(stale[a++]);
+      }
+      else if (a == stale.size() || fresh[b].length < stale[a].length)
+      {
+        added.push_back(fresh[b++]);
+      }
+      else
+      {
+        // same length, so the same cells; unchanged only if the word is
+        if (stale[a].word != fresh[b].word)
+        {
+          removed.push_back(stale[a]);
+          added.push_back(fresh[b]);
+        }
+        a++;
+        b++;
+      }
+    }
+    if (fresh.empty())
+    {
+      if (found != rays.end())
+      {
+        rays.erase(found);
+      }
+    }
+    else if (found == rays.end())
+    {
+      rays[keys[i]] = fresh;
+    }
+    else
+    {
+      found->second = fresh;
+    }
+  }
+}
+
+std::vector<Match> IncrementalSolver::getMatches(void) const
+{
+  std::vector<Match> matches;
+  for (auto ray = rays.begin(); ray != rays.end(); ++ray)
+  {
+    matches.insert(matches.end(), ray->second.begin(), ray->second.end());
+  }
+  if (searcher.getOptions().dedup != DEDUP_OFF)
+  {
+    dedupMatches(searcher.getDictionary(), matches);
+  }
+  return matches;
+}
+
+void IncrementalSolver::searchRay(int key, std::vector<Match>& matches) const
+{
+  SearchOptions options = searcher.getOptions();
+  int cell = key / Grid::DIRECTIONS;
+  options.directions = 1 << (key % Grid::DIRECTIONS);
+  if (options.engine == ENGINE_HASH)
+  {
+    searchDirectionsHashed(searcher.getDictionary(), grid, cell / grid.getWidth(), cell % grid.getWidth(), options, NULL, matches);
+  }
+  else
+  {
+    searchDirections(searcher.getDictionary(), grid, cell / grid.getWidth(), cell % grid.getWidth(), options, NULL, matches);
+  }
+}
@@ -0,0 +1,41 @@
+#include <vector>
+#include <map>
+#include "Grid.h"
+#include "MatchSink.h"
+#include "WordSearcher.h"
+
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+// Keeps the matches of one grid current while its letters change. A
+// letter change re-searches only the rays that pass through the cell,
+// at most 8 * getMax() of them, instead of the whole grid.
+class IncrementalSolver
+{
+public:
+  // solves the grid once in full; the searcher must outlive the solver
+  IncrementalSolver(const WordSearcher& searcher, Grid grid);
+  // tied to its searcher; not copied or moved
+  IncrementalSolver(const IncrementalSolver&) = delete;
+  IncrementalSolver& operator=(const IncrementalSolver&) = delete;
+  const Grid& getGrid(void) const { return grid; }
+  // an edit outside the grid changes nothing
+  void setLetter(int col, int row, char letter);
+  // every match in scan order, deduplicated if the options ask for it
+  std::vector<Match> getMatches(void) const;
+  // what the last setLetter took away and added, in scan order
+  const std::vector<Match>& getRemoved(void) const { return removed; }
+  const std::vector<Match>& getAdded(void) const { return added; }
+private:
+  int rayKey(int col, int row, int direction) const { return (row * grid.getWidth() + col) * Grid::DIRECTIONS + direction; }
+  void searchRay(int key, std::vector<Match>& matches) const;
+  const WordSearcher& searcher;
+  Grid grid;
+  // the matches of each ray that has any, keyed by rayKey so that
+  // iteration is in scan order
+  std::map<int, std::vector<Match>> rays;
+  std::vector<Match> removed;
+  std::vector<Match> added;
+};
+
+#endif //INCREMENTAL_H
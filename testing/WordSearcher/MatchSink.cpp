@@ -0,0 +1,104 @@
+#include "MatchSink.h"
+#include "Grid.h"
+#include <iostream>
+#include <string>
+
+/******* PRIVATE FUNCTION DECLARATIONS *********/
+
+// named by the step they take, in Grid::ROW_STEP/COL_STEP order
+const char* const DIRECTION_NAMES[Grid::DIRECTIONS] = {
+  "up-left", "up", "up-right", "left", "right", "down-left", "down", "down-right"
+};
+
+void appendQuoted(std::string& buffer, std::string_view text, bool json);
+
+StreamSink::StreamSink(const Dictionary& dict, std::ostream& out, int format) : dict(dict), out(out), format(format)
+{
+  buffer.reserve(FLUSH_BYTES + 256);
+  if (format == FORMAT_CSV)
+  {
+    buffer += "grid,word,row,col,direction,length\n";
+  }
+}
+
+StreamSink::~StreamSink()
+{
+  flush();
+}
+
+void StreamSink::beginGrid(std::string name)
+{
+  grid = name;
+  if (format == FORMAT_TEXT)
+  {
+    buffer += "GRID: ";
+    buffer += name;
+    buffer += '\n';
+  }
+}
+
+void StreamSink::add(const Match& match)
+{
+  std::string word = dict.getWord(match.word);
+  if (format == FORMAT_TEXT)
+  {
+    buffer += "MATCH: ";
+    buffer += word;
+    buffer += '\n';
+  }
+  else
+  {
+    bool csv = format == FORMAT_CSV;
+    buffer += csv ? "" : "{\"grid\": ";
+    appendQuoted(buffer, grid, !csv);
+    buffer += csv ? "," : ", \"word\": ";
+    appendQuoted(buffer, word, !csv);
+    buffer += csv ? "," : ", \"row\": ";
+    buffer += std::to_string(match.row);
+    buffer += csv ? "," : ", \"col\": ";
+    buffer += std::to_string(match.col);
+    buffer += csv ? "," : ", \"direction\": ";
+    appendQuoted(buffer, DIRECTION_NAMES[match.direction], !csv);
+    buffer += csv ? "," : ", \"length\": ";
+    buffer += std::to_string(match.length);
+    buffer += csv ? "\n" : "}\n";
+  }
+  if (buffer.size() >= FLUSH_BYTES)
+  {
+    out.write(buffer.data(), buffer.size());
+    buffer.clear();
+  }
+}
+
+void StreamSink::flush(void)
+{
+  out.write(buffer.data(), buffer.size());
+  buffer.clear();
+  out.flush();
+}
+
+// CSV doubles embedded quotes, JSON backslash-escapes quotes and
+// backslashes and writes bytes below 0x20 as \u00XX. Grid names are
+// file names, words are whatever the dictionary held.
+void appendQuoted(std::string& buffer, std::string_view text, bool json)
+{
+  const char* hex = "0123456789abcdef";
+  buffer += '"';
+  for (int i = 0; i < text.length(); i++)
+  {
+    unsigned char byte = text[i];
+    if (json && byte < 0x20)
+    {
+      buffer += "\\u00";
+      buffer += hex[byte >> 4];
+      buffer += hex[byte & 15];
+      continue;
+    }
+    if (text[i] == '"' || (json && text[i] == '\\'))
+    {
+      buffer += json ? '\\' : '"';
+    }
+    buffer += text[i];
+  }
+  buffer += '"';
+}
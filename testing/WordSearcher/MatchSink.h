@@ -0,0 +1,74 @@
+#include <vector>
+#include <iostream>
+#include <string>
+#include <functional>
+#include "Dictionary.h"
+
+#ifndef MATCHSINK_H
+#define MATCHSINK_H
+
+// One hit: the dictionary index of the word and where its ray starts.
+struct Match
+{
+  int word;
+  int row;
+  int col;
+  int direction;
+  int length;
+};
+
+// Receives matches as a solver produces them. beginGrid marks the start
+// of each grid's matches; flush pushes out anything still buffered.
+class MatchSink
+{
+public:
+  virtual ~MatchSink() {}
+  virtual void beginGrid(std::string name) {}
+  virtual void add(const Match& match) = 0;
+  virtual void flush(void) {}
+};
+
+// Keeps every match, for library use.
+class VectorSink : public MatchSink
+{
+public:
+  void add(const Match& match) { matches.push_back(match); }
+  std::vector<Match> matches;
+};
+
+// Hands each match to a function.
+class CallbackSink : public MatchSink
+{
+public:
+  CallbackSink(std::function<void(const Match&)> callback) : callback(callback) {}
+  void add(const Match& match) { callback(match); }
+private:
+  std::function<void(const Match&)> callback;
+};
+
+// Formats matches into a buffer and writes it to the stream in blocks of
+// FLUSH_BYTES, and once more on flush or destruction.
+//   FORMAT_TEXT   GRID: name / MATCH: word lines
+//   FORMAT_CSV    grid,word,row,col,direction,length with a header line
+//   FORMAT_JSON   one object per line with the same fields
+class StreamSink : public MatchSink
+{
+public:
+  static const int FORMAT_TEXT = 0;
+  static const int FORMAT_CSV = 1;
+  static const int FORMAT_JSON = 2;
+  StreamSink(const Dictionary& dict, std::ostream& out, int format);
+  ~StreamSink();
+  void beginGrid(std::string name);
+  void add(const Match& match);
+  void flush(void);
+private:
+  static const size_t FLUSH_BYTES = 1 << 16;
+  const Dictionary& dict;
+  std::ostream& out;
+  int format;
+  std::string grid;
+  std::string buffer;
+};
+
+#endif //MATCHSINK_H
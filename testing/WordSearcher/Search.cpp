@@ -0,0 +1,366 @@
+#include "Search.h"
+#include "Stats.h"
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#ifdef _GLIBCXX_HAS_GTHREADS
+#include <thread>
+#endif
+
+/******* PRIVATE FUNCTION DECLARATIONS *********/
+
+inline bool rayCanMatch(const Dictionary& dict, const char* ray, int length, int minLength);
+template <bool WRAP, int MIN_LEN, bool DEDUP>
+inline void walkRay(const Dictionary& dict, const Grid& grid, int row, int col, int direction, int minLength, FoundSet* found, std::vector<Match>& matches);
+template <int DIRECTIONS_MASK, bool WRAP, int MIN_LEN, bool DEDUP>
+void searchRows(const Dictionary& dict, const Grid& grid, int firstRow, int lastRow, const SearchOptions& options, FoundSet* found, std::vector<Match>& matches);
+void searchRowsHashed(const Dictionary& dict, const Grid& grid, int firstRow, int lastRow, const SearchOptions& options, FoundSet* found, std::vector<Match>& matches);
+
+FoundSet::FoundSet(const Dictionary& dict, int dedup, int minLength) : dict(dict), bits((dict.size() + 63) / 64, 0)
+{
+  if (dedup == DEDUP_PRUNE)
+  {
+    dict.countWords(minLength, remaining);
+  }
+}
+
+FoundSet::FoundSet(const Dictionary& dict, int dedup, const std::vector<int>& counts) : dict(dict), bits((dict.size() + 63) / 64, 0)
+{
+  if (dedup == DEDUP_PRUNE)
+  {
+    remaining = counts;
+  }
+}
+
+// Splits the grid into one band of rows per worker. Each band collects
+// its matches locally and the bands are joined in row order, so the
+// result is the same for any worker count. With dedup each band keeps
+// its own FoundSet, starting from one shared count of the trie, and
+// repeats across bands are dropped when joining.
+std::vector<Match> findMatches(const Dictionary& dict, const Grid& grid, const SearchOptions& options, const std::vector<int>* counts)
+{
+  int height = grid.getHeight();
+  int workers = options.workers;
+#ifdef _GLIBCXX_HAS_GTHREADS
+  if (workers <= 0) {
+    workers = std::thread::hardware_concurrency();
+  }
+#else
+  workers = 1;
+#endif
+  if (workers > height) {workers = height;}
+  if (workers < 1) {workers = 1;}
+
+  std::vector<int> counted;
+  if (options.dedup == DEDUP_PRUNE && counts == NULL) {
+    dict.countWords(options.minLength, counted);
+  }
+  const std::vector<int>& shared = counts ? *counts : counted;
+  SearchKernel kernel = selectKernel(options);
+  std::vector<std::vector<Match>> bands(workers);
+  auto searchBand = [&](int i) {
+    int firstRow = height * i / workers, lastRow = height * (i + 1) / workers;
+    if (options.dedup == DEDUP_OFF) {
+      kernel(dict, grid, firstRow, lastRow, options, NULL, bands[i]);
+    } else {
+      FoundSet found = FoundSet(dict, options.dedup, shared);
+      kernel(dict, grid, firstRow, lastRow, options, &found, bands[i]);
+    }
+  };
+  std::vector<Stats> bandStats(workers);
+#ifdef _GLIBCXX_HAS_GTHREADS
+  std::vector<std::thread> threads;
+  for (int i = 1; i < workers; i++) {
+    threads.push_back(std::thread([&, i]() {
+      searchBand(i);
+      STATS_TAKE(bandStats[i]);
+    }));
+  }
+#endif
+  searchBand(0);
+#ifdef _GLIBCXX_HAS_GTHREADS
+  for (int i = 0; i < threads.size(); i++) {
+    threads[i].join();
+    STATS_MERGE(bandStats[i + 1]);
+  }
+#endif
+
+  std::vector<Match> matches = std::move(bands[0]);
+  for (int i = 1; i < workers; i++) {
+    matches.insert(matches.end(), bands[i].begin(), bands[i].end());
+  }
+  if (options.dedup != DEDUP_OFF && workers > 1) {
+    dedupMatches(dict, matches);
+  }
+  return matches;
+}
+
+void dedupMatches(const Dictionary& dict, std::vector<Match>& matches)
+{
+  FoundSet found = FoundSet(dict, DEDUP_REPORT, 0);
+  int kept = 0;
+  for (int i = 0; i < matches.size(); i++) {
+    if (found.insert(matches[i].word)) {
+      matches[kept++] = matches[i];
+    }
+  }
+  matches.resize(kept);
+}
+
+// Keeps the first 2 * reach rows (the rays of the last rows wrap into
+// them) and a ring of the last 2 * reach + 1 rows read, where reach is
+// how far a ray goes past its start. Start row r is searched once row
+// r + reach has been read; the first and last reach rows wait for the
+// end of the file, when both their wrap partners are resident.
+void streamMatches(const Dictionary& dict, std::string filename, const SearchOptions& options, MatchSink& sink)
+{
+  GridReader reader(filename);
+  int width = reader.getWidth(), height = reader.getHeight();
+  int reach = dict.getMax() > 1 ? dict.getMax() - 1 : 0;
+  int headRows = 2 * reach, ringRows = 2 * reach + 1;
+  if (height <= headRows + ringRows) {
+    // small enough to hold whole
+    Grid grid = Grid(filename);
+    grid.buildRays(dict.getMax());
+    SearchOptions single = options;
+    single.engine = ENGINE_TRIE;
+    single.workers = 1;
+    std::vector<Match> matches = findMatches(dict, grid, single);
+    for (int i = 0; i < matches.size(); i++) {
+      sink.add(matches[i]);
+    }
+    return;
+  }
+
+  std::vector<char> head(headRows * width), ring(ringRows * width);
+  FoundSet found = FoundSet(dict, options.dedup, options.minLength);
+  auto rowAt = [&](int row) -> const char* {
+    return row < headRows ? &head[row * width] : &ring[(row % ringRows) * width];
+  };
+  auto searchRow = [&](int row) {
+    for (int col = 0; col < width; col++) {
+      for (int direction = 0; direction < Grid::DIRECTIONS; direction++) {
+        if (!(options.directions >> direction & 1)) {continue;}
+        int node = dict.indexRoot();
+        int r = row, c = col;
+        STATS_ADD(rays, 1);
+        for (int i = 0; i <= reach; i++) {
+          node = dict.walk(node, rowAt(r)[c]);
+          STATS_ADD(letters, 1);
+          if (node == -1 || found.exhausted(node)) {break;}
+          int word = dict.nodeWord(node);
+          if (i + 1 >= options.minLength && word != -1 && (options.dedup == DEDUP_OFF || found.insert(word))) {
+            sink.add({word, row, col, direction, i + 1});
+            STATS_ADD(matches, 1);
+          }
+          r += Grid::ROW_STEP[direction];
+          c += Grid::COL_STEP[direction];
+          if (r < 0 || r >= height || c < 0 || c >= width) {
+            if (!options.wrap) {break;}
+            r = (r + height) % height;
+            c = (c + width) % width;
+          }
+        }
+      }
+    }
+  };
+
+  for (int row = 0; row < height; row++) {
+    char* slot = &ring[(row % ringRows) * width];
+    if (!reader.readRow(slot)) {
+      return;
+    }
+    if (row < headRows) {
+      std::copy(slot, slot + width, &head[row * width]);
+    } else {
+      searchRow(row - reach);
+    }
+  }
+  for (int row = height - reach; row < height; row++) {
+    searchRow(row);
+  }
+  for (int row = 0; row < reach; row++) {
+    searchRow(row);
+  }
+}
+
+// The kernels take a FoundSet exactly when options.dedup is on; callers
+// of findMatchesInRows may pass one or not either way.
+void findMatchesInRows(const Dictionary& dict, const Grid& grid, int firstRow, int lastRow, const SearchOptions& options, FoundSet* found, std::vector<Match>& matches)
+{
+  SearchOptions selected = options;
+  if (found == NULL) {
+    selected.dedup = DEDUP_OFF;
+  } else if (selected.dedup == DEDUP_OFF) {
+    selected.dedup = DEDUP_REPORT;
+  }
+  selectKernel(selected)(dict, grid, firstRow, lastRow, options, found, matches);
+}
+
+// Each choice below fixes one template parameter; anything not listed
+// falls through to 0, which leaves that option to run time.
+template <int DIRECTIONS_MASK, bool WRAP, int MIN_LEN>
+SearchKernel selectDedup(const SearchOptions& options)
+{
+  if (options.dedup == DEDUP_OFF) {
+    return searchRows<DIRECTIONS_MASK, WRAP, MIN_LEN, false>;
+  }
+  return searchRows<DIRECTIONS_MASK, WRAP, MIN_LEN, true>;
+}
+
+template <int DIRECTIONS_MASK, bool WRAP>
+SearchKernel selectMinLength(const SearchOptions& options)
+{
+  switch (options.minLength) {
+    case 3: return selectDedup<DIRECTIONS_MASK, WRAP, 3>(options);
+    case MIN_LENGTH: return selectDedup<DIRECTIONS_MASK, WRAP, MIN_LENGTH>(options);
+    default: return selectDedup<DIRECTIONS_MASK, WRAP, 0>(options);
+  }
+}
+
+template <int DIRECTIONS_MASK>
+SearchKernel selectWrap(const SearchOptions& options)
+{
+  if (options.wrap) {
+    return selectMinLength<DIRECTIONS_MASK, true>(options);
+  }
+  return selectMinLength<DIRECTIONS_MASK, false>(options);
+}
+
+SearchKernel selectKernel(const SearchOptions& options)
+{
+  if (options.engine == ENGINE_HASH) {
+    return searchRowsHashed;
+  }
+  switch (options.directions) {
+    case ALL_DIRECTIONS: return selectWrap<ALL_DIRECTIONS>(options);
+    case ACROSS_DOWN: return selectWrap<ACROSS_DOWN>(options);
+    default: return selectWrap<0>(options);
+  }
+}
+
+// A zero DIRECTIONS_MASK or MIN_LEN reads that option at run time.
+template <int DIRECTIONS_MASK, bool WRAP, int MIN_LEN, bool DEDUP>
+void searchRows(const Dictionary& dict, const Grid& grid, int firstRow, int lastRow, const SearchOptions& options, FoundSet* found, std::vector<Match>& matches)
+{
+  int width = grid.getWidth();
+  int mask = DIRECTIONS_MASK ? DIRECTIONS_MASK : options.directions;
+  for (int row = firstRow; row < lastRow; row++) {
+    for (int col = 0; col < width; col++) {
+      for (int direction = 0; direction < Grid::DIRECTIONS; direction++) {
+        if (mask >> direction & 1) {
+          walkRay<WRAP, MIN_LEN, DEDUP>(dict, grid, row, col, direction, options.minLength, found, matches);
+        }
+      }
+    }
+  }
+}
+
+void searchRowsHashed(const Dictionary& dict, const Grid& grid, int firstRow, int lastRow, const SearchOptions& options, FoundSet* found, std::vector<Match>& matches)
+{
+  int width = grid.getWidth();
+  for (int row = firstRow; row < lastRow; row++) {
+    for (int col = 0; col < width; col++) {
+      searchDirectionsHashed(dict, grid, row, col, options, found, matches);
+    }
+  }
+}
+
+// The cell search behind the incremental solver; it picks a walk per
+// direction rather than a whole kernel.
+void searchDirections(const Dictionary& dict, const Grid& grid, int row, int col, const SearchOptions& options, FoundSet* found, std::vector<Match>& matches)
+{
+  for (int direction = 0; direction < Grid::DIRECTIONS; direction++) {
+    if (!(options.directions >> direction & 1)) {continue;}
+    if (options.wrap) {
+      if (found) {
+        walkRay<true, 0, true>(dict, grid, row, col, direction, options.minLength, found, matches);
+      } else {
+        walkRay<true, 0, false>(dict, grid, row, col, direction, options.minLength, found, matches);
+      }
+    } else {
+      if (found) {
+        walkRay<false, 0, true>(dict, grid, row, col, direction, options.minLength, found, matches);
+      } else {
+        walkRay<false, 0, false>(dict, grid, row, col, direction, options.minLength, found, matches);
+      }
+    }
+  }
+}
+
+// Without wrap a ray is cut at the edge; up to there the wrapped ray
+// buffer holds the same letters. The first MIN_LEN - 1 letters only
+// extend the prefix, so the word check starts after them.
+template <bool WRAP, int MIN_LEN, bool DEDUP>
+void walkRay(const Dictionary& dict, const Grid& grid, int row, int col, int direction, int minLength, FoundSet* found, std::vector<Match>& matches)
+{
+  if (MIN_LEN) {
+    minLength = MIN_LEN;
+  }
+  int length = WRAP ? grid.getRayLength() : std::min(grid.getRayLength(), grid.getEdgeDistance(col, row, direction));
+  const char* ray = grid.getRay(col, row, direction);
+  if (!rayCanMatch(dict, ray, length, minLength)) {return;}
+  int node = dict.indexRoot();
+  STATS_ADD(rays, 1);
+
+  int i = 0;
+  for (; i < minLength - 1; i++) {
+    // stop the ray as soon as no word starts with its first i + 1 letters
+    // or, when pruning, once everything it could still spell is found
+    node = dict.walk(node, ray[i]);
+    STATS_ADD(letters, 1);
+    if (node == -1 || (DEDUP && found->exhausted(node))) {return;}
+  }
+  for (; i < length; i++) {
+    node = dict.walk(node, ray[i]);
+    STATS_ADD(letters, 1);
+    if (node == -1 || (DEDUP && found->exhausted(node))) {return;}
+    int word = dict.nodeWord(node);
+    if (word != -1 && (!DEDUP || found->insert(word))) {
+      matches.push_back({word, row, col, direction, i + 1});
+      STATS_ADD(matches, 1);
+    }
+  }
+}
+
+// Extends a rolling hash and a packed key one letter at a time and probes
+// the table for the current length; no prefix pruning, every ray runs
+// its full length.
+void searchDirectionsHashed(const Dictionary& dict, const Grid& grid, int row, int col, const SearchOptions& options, FoundSet* found, std::vector<Match>& matches)
+{
+  for (int direction = 0; direction < Grid::DIRECTIONS; direction++) {
+    if (!(options.directions >> direction & 1)) {continue;}
+    int length = options.wrap ? grid.getRayLength() : std::min(grid.getRayLength(), grid.getEdgeDistance(col, row, direction));
+    const char* ray = grid.getRay(col, row, direction);
+    if (!rayCanMatch(dict, ray, length, options.minLength)) {continue;}
+    uint64_t hash = 0, key = 0;
+    STATS_ADD(rays, 1);
+
+    for (int i = 0; i < length; i++) {
+      hash = Dictionary::extendHash(hash, ray[i]);
+      key = Dictionary::extendKey(key, i, ray[i]);
+      STATS_ADD(letters, 1);
+      if (i + 1 >= options.minLength) {
+        int word = dict.lookupHashed(std::string_view(ray, i + 1), hash, key);
+        if (word != -1 && (!found || found->insert(word))) {
+          matches.push_back({word, row, col, direction, i + 1});
+          STATS_ADD(matches, 1);
+        }
+      }
+    }
+  }
+}
+
+// Prefilter ahead of a walk: a ray shorter than minLength holds no
+// reportable word, and neither does one whose first two or three
+// letters begin no word that long.
+bool rayCanMatch(const Dictionary& dict, const char* ray, int length, int minLength)
+{
+  if (length < minLength) {
+    return false;
+  }
+  if (minLength >= 3) {
+    return dict.startsWord3(ray);
+  }
+  return minLength < 2 || dict.startsWord2(ray);
+}
@@ -0,0 +1,114 @@
+#include <vector>
+#include <iostream>
+#include "Dictionary.h"
+#include "Grid.h"
+#include "MatchSink.h"
+
+#ifndef SEARCH_H
+#define SEARCH_H
+
+const int MIN_LENGTH = 5;
+
+// search engines: trie walk per start cell, Aho-Corasick over whole
+// lines (see AhoCorasick.h), per-length hash tables probed with a
+// rolling hash per start cell
+const int ENGINE_TRIE = 0;
+const int ENGINE_AHO_CORASICK = 1;
+const int ENGINE_HASH = 2;
+
+// repeated words: all reported, each reported once at its first
+// occurrence in scan order, or once with trie rays also cut short when
+// every word they could still reach has been found
+const int DEDUP_OFF = 0;
+const int DEDUP_REPORT = 1;
+const int DEDUP_PRUNE = 2;
+
+// bit d selects Grid direction d
+const int ALL_DIRECTIONS = (1 << Grid::DIRECTIONS) - 1;
+// right and down only, as in a crossword
+const int ACROSS_DOWN = (1 << 4) | (1 << 6);
+
+// Everything a solve can vary.
+struct SearchOptions
+{
+  int engine = ENGINE_TRIE;
+  int minLength = MIN_LENGTH;
+  int directions = ALL_DIRECTIONS;
+  // rays run off one edge onto the opposite one; without wrap a ray
+  // ends at the edge
+  bool wrap = true;
+  int dedup = DEDUP_OFF;
+  // worker threads for the trie and hash engines, 0 = one per hardware
+  // thread
+  int workers = 1;
+};
+
+// Dictionary words already reported, one bit per word index.
+class FoundSet
+{
+public:
+  FoundSet(const Dictionary& dict, int dedup, int minLength);
+  // with counts from Dictionary::countWords, so pruning solves need not
+  // count the trie again
+  FoundSet(const Dictionary& dict, int dedup, const std::vector<int>& counts);
+  // true the first time word is inserted
+  inline bool insert(int word);
+  // with DEDUP_PRUNE, true once every word at or below the trie node has
+  // been inserted
+  bool exhausted(int node) const { return !remaining.empty() && remaining[node] == 0; }
+private:
+  const Dictionary& dict;
+  std::vector<uint64_t> bits;
+  std::vector<int> remaining;
+};
+
+// counts is Dictionary::countWords for options.minLength, used with
+// DEDUP_PRUNE; when NULL it is counted once for this call
+std::vector<Match> findMatches(const Dictionary& dict, const Grid& grid, const SearchOptions& options, const std::vector<int>* counts = NULL);
+// drops the repeats from matches that were not searched with a FoundSet
+void dedupMatches(const Dictionary& dict, std::vector<Match>& matches);
+// The row and cell searches append to matches, and skip words already in
+// found unless it is NULL. They read the grid's ray buffers in place, so
+// once matches has grown to its working size they do not allocate.
+void findMatchesInRows(const Dictionary& dict, const Grid& grid, int firstRow, int lastRow, const SearchOptions& options, FoundSet* found, std::vector<Match>& matches);
+// A findMatchesInRows compiled for one set of options. The trie kernel is
+// instantiated for all directions and ACROSS_DOWN, with and without
+// wrap, for minLength 3 and MIN_LENGTH, with and without a FoundSet;
+// other combinations get a kernel that reads them at run time.
+// selectKernel picks once and the rows are then searched without
+// branching on options that are not in use.
+typedef void (*SearchKernel)(const Dictionary& dict, const Grid& grid, int firstRow, int lastRow, const SearchOptions& options, FoundSet* found, std::vector<Match>& matches);
+SearchKernel selectKernel(const SearchOptions& options);
+// Solves a grid file while holding only O(getMax()) rows of it. Matches
+// go to the sink as they are found, rows in the order they become
+// solvable.
+// The engine and worker options do not apply.
+void streamMatches(const Dictionary& dict, std::string filename, const SearchOptions& options, MatchSink& sink);
+void searchDirections(const Dictionary& dict, const Grid& grid, int row, int col, const SearchOptions& options, FoundSet* found, std::vector<Match>& matches);
+void searchDirectionsHashed(const Dictionary& dict, const Grid& grid, int row, int col, const SearchOptions& options, FoundSet* found, std::vector<Match>& matches);
+
+// Walks the word's trie path when pruning, so each node's count of
+// unfound words stays exact.
+bool FoundSet::insert(int word)
+{
+  uint64_t bit = 1ULL << (word & 63);
+  if (bits[word >> 6] & bit)
+  {
+    return false;
+  }
+  bits[word >> 6] |= bit;
+  if (!remaining.empty())
+  {
+    std::string text = dict.getWord(word);
+    int node = dict.indexRoot();
+    remaining[node]--;
+    for (int i = 0; i < text.length(); i++)
+    {
+      node = dict.walk(node, text[i]);
+      remaining[node]--;
+    }
+  }
+  return true;
+}
+
+#endif //SEARCH_H
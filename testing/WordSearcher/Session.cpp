@@ -0,0 +1,135 @@
+#include "Session.h"
+#include "Search.h"
+#include "Batch.h"
+#include "Stats.h"
+#include <iostream>
+#include <vector>
+
+/******* PRIVATE FUNCTION DECLARATIONS *********/
+
+void sortWords(Dictionary& dict, int algorithm);
+
+// Uses dictionary.bin when present, otherwise reads and sorts
+// dictionary.txt with the given algorithm.
+Session::Session(int algorithm, SearchOptions options, bool packWords)
+{
+  bool precompiled = loadDictionary();
+  if (!precompiled)
+  {
+    STATS_TIMER(sortMs);
+    sortWords(dict, algorithm);
+  }
+  STATS_TIMER(loadMs);
+  if (!precompiled)
+  {
+    dict.buildIndex();
+  }
+  if (packWords)
+  {
+    dict.packWords();
+  }
+  searcher.reset(new WordSearcher(dict, options));
+}
+
+// Returns true when the precompiled dictionary was used, false when the
+// text words still need sorting and indexing.
+bool Session::loadDictionary(void)
+{
+  STATS_TIMER(loadMs);
+  if (dict.loadBinary("dictionary.bin"))
+  {
+    return true;
+  }
+  dict.readWords("dictionary.txt");
+  return false;
+}
+
+std::vector<Match> Session::solve(Grid& grid) const
+{
+  STATS_TIMER(searchMs);
+  return searcher->solve(grid);
+}
+
+void Session::solveFile(std::string filename, MatchSink& sink) const
+{
+  Grid grid = parseGrid(filename);
+  report(filename, grid, sink);
+}
+
+// A single file keeps the worker threads for itself.
+void Session::solveFiles(const std::vector<std::string>& filenames, MatchSink& sink) const
+{
+  if (filenames.size() == 1)
+  {
+    solveFile(filenames[0], sink);
+    return;
+  }
+  solveBatch(*searcher, filenames, searcher->getOptions().workers, sink);
+}
+
+void Session::solveStream(std::istream& in, MatchSink& sink) const
+{
+  for (int n = 1; in >> std::ws && !in.eof(); n++)
+  {
+    Grid grid = parseGrid(in);
+    if (grid.getWidth() == 0)
+    {
+      break;
+    }
+    report("stdin #" + std::to_string(n), grid, sink);
+  }
+}
+
+void Session::streamFile(std::string filename, MatchSink& sink) const
+{
+  STATS_TIMER(searchMs);
+  sink.beginGrid(filename);
+  streamMatches(dict, filename, searcher->getOptions(), sink);
+}
+
+Grid Session::parseGrid(std::string filename)
+{
+  STATS_TIMER(parseMs);
+  return Grid(filename);
+}
+
+Grid Session::parseGrid(std::istream& in)
+{
+  STATS_TIMER(parseMs);
+  return Grid(in);
+}
+
+void Session::report(std::string name, Grid& grid, MatchSink& sink) const
+{
+  std::vector<Match> matches = solve(grid);
+  sink.beginGrid(name);
+  for (int i = 0; i < matches.size(); i++)
+  {
+    sink.add(matches[i]);
+  }
+}
+
+void sortWords(Dictionary& dict, int algorithm)
+{
+  switch(algorithm)
+  {
+    case 0:
+      	dict.selectionSort();
+      	break;
+    case 1:
+ 	dict.quickSort();
+      	break;
+    case 2:
+      	dict.heapSort(); 
+      	break;
+    case 3:
+      	dict.radixSort();
+      	break;
+    case 4:
+      	dict.introSort();
+      	break;
+    default:
+      	dict.radixSort();
+      	break;
+  }
+}
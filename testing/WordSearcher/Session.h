@@ -0,0 +1,42 @@
+#include <vector>
+#include <iostream>
+#include <memory>
+#include "Dictionary.h"
+#include "Grid.h"
+#include "MatchSink.h"
+#include "WordSearcher.h"
+
+#ifndef SESSION_H
+#define SESSION_H
+
+// A dictionary loaded and indexed once, then used for any number of
+// grids read from files and streams.
+class Session
+{
+public:
+  // packWords selects the dictionary's encoded mode (Dictionary::packWords)
+  Session(int algorithm, SearchOptions options, bool packWords = false);
+  // the searcher points at dict, so a session stays where it was built
+  Session(const Session&) = delete;
+  Session& operator=(const Session&) = delete;
+  const Dictionary& getDictionary(void) const { return dict; }
+  std::vector<Match> solve(Grid& grid) const;
+  // the file* functions report each grid to sink, beginGrid first
+  void solveFile(std::string filename, MatchSink& sink) const;
+  // many grid files at once, reported in the given order
+  void solveFiles(const std::vector<std::string>& filenames, MatchSink& sink) const;
+  // grids back to back in one stream, until it runs out
+  void solveStream(std::istream& in, MatchSink& sink) const;
+  // a grid too large to hold, searched a window of rows at a time
+  void streamFile(std::string filename, MatchSink& sink) const;
+  // Grid constructors, timed as the parse phase
+  static Grid parseGrid(std::string filename);
+  static Grid parseGrid(std::istream& in);
+private:
+  bool loadDictionary(void);
+  void report(std::string name, Grid& grid, MatchSink& sink) const;
+  Dictionary dict;
+  std::unique_ptr<WordSearcher> searcher;
+};
+
+#endif //SESSION_H
@@ -0,0 +1,36 @@
+#include "Stats.h"
+#include <iostream>
+
+#ifdef WS_STATS
+thread_local Stats threadStats = Stats();
+#endif
+
+void Stats::merge(const Stats& other)
+{
+  loadMs += other.loadMs;
+  sortMs += other.sortMs;
+  parseMs += other.parseMs;
+  searchMs += other.searchMs;
+  lookups += other.lookups;
+  probes += other.probes;
+  rays += other.rays;
+  letters += other.letters;
+  matches += other.matches;
+}
+
+void Stats::print(std::ostream& out, bool json) const
+{
+  if (json)
+  {
+    out << "{\"load_ms\": " << loadMs << ", \"sort_ms\": " << sortMs
+        << ", \"parse_ms\": " << parseMs << ", \"search_ms\": " << searchMs
+        << ", \"lookups\": " << lookups << ", \"probes\": " << probes
+        << ", \"rays\": " << rays << ", \"letters\": " << letters
+        << ", \"matches\": " << matches << "}" << std::endl;
+    return;
+  }
+  out << "load " << loadMs << " ms, sort " << sortMs << " ms, parse "
+      << parseMs << " ms, search " << searchMs << " ms" << std::endl;
+  out << lookups << " lookups (" << probes << " probes), " << rays
+      << " rays, " << letters << " letters, " << matches << " matches" << std::endl;
+}
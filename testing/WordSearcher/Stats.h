@@ -0,0 +1,60 @@
+#include <iostream>
+#include <chrono>
+
+#ifndef STATS_H
+#define STATS_H
+
+// Solver instrumentation, compiled in with -DWS_STATS (make STATS=1).
+// Each thread counts into its own threadStats; workers hand theirs back
+// to the thread that started them, which merges them.
+struct Stats
+{
+  double loadMs;
+  double sortMs;
+  double parseMs;
+  double searchMs;
+  long lookups;
+  long probes;
+  long rays;
+  long letters;
+  long matches;
+  void merge(const Stats& other);
+  void print(std::ostream& out, bool json) const;
+};
+
+#ifdef WS_STATS
+
+extern thread_local Stats threadStats;
+
+// Adds the wall time of its scope to one of the *Ms fields.
+class StatsTimer
+{
+public:
+  StatsTimer(double Stats::*field) : field(field), start(std::chrono::steady_clock::now()) {}
+  ~StatsTimer()
+  {
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    threadStats.*field += elapsed.count();
+  }
+private:
+  double Stats::*field;
+  std::chrono::steady_clock::time_point start;
+};
+
+#define STATS_ADD(counter, n) (threadStats.counter += (n))
+#define STATS_TIMER(field) StatsTimer statsTimer(&Stats::field)
+#define STATS_TAKE(into) ((into) = threadStats, threadStats = Stats())
+#define STATS_MERGE(from) threadStats.merge(from)
+#define STATS_DUMP(out, json) (threadStats.print(out, json), threadStats = Stats())
+
+#else
+
+#define STATS_ADD(counter, n) ((void)0)
+#define STATS_TIMER(field) ((void)0)
+#define STATS_TAKE(into) ((void)0)
+#define STATS_MERGE(from) ((void)0)
+#define STATS_DUMP(out, json) ((void)0)
+
+#endif //WS_STATS
+
+#endif //STATS_H
@@ -0,0 +1,69 @@
+#include "WordSearcher.h"
+#include <vector>
+
+WordSearcher::WordSearcher(const Dictionary& dict, SearchOptions options) : dict(dict), options(options)
+{
+  if (options.engine == ENGINE_AHO_CORASICK)
+  {
+    automaton.reset(new AhoCorasick(dict, options.minLength));
+  }
+  else if (options.dedup == DEDUP_PRUNE)
+  {
+    dict.countWords(options.minLength, wordCounts);
+  }
+}
+
+std::vector<Match> WordSearcher::solve(Grid& grid) const
+{
+  return solve(grid, options.workers);
+}
+
+std::vector<Match> WordSearcher::solve(Grid& grid, int workers) const
+{
+  if (grid.getRayLength() < dict.getMax())
+  {
+    grid.buildRays(dict.getMax());
+  }
+  if (automaton)
+  {
+    std::vector<Match> matches = automaton->findMatches(grid, options.directions, options.wrap);
+    if (options.dedup != DEDUP_OFF)
+    {
+      dedupMatches(dict, matches);
+    }
+    return matches;
+  }
+  SearchOptions run = options;
+  run.workers = workers;
+  return findMatches(dict, grid, run, options.dedup == DEDUP_PRUNE ? &wordCounts : NULL);
+}
+
+void WordSearcher::solve(Grid& grid, MatchSink& sink) const
+{
+  std::vector<Match> matches = solve(grid);
+  for (int i = 0; i < matches.size(); i++)
+  {
+    sink.add(matches[i]);
+  }
+}
+
+// An empty or negative size has no letters and no matches.
+std::vector<Match> WordSearcher::solve(const char* letters, int width, int height) const
+{
+  if (width <= 0 || height <= 0)
+  {
+    return std::vector<Match>();
+  }
+  Grid grid = Grid(letters, width, height);
+  return solve(grid);
+}
+
+void WordSearcher::solve(const char* letters, int width, int height, MatchSink& sink) const
+{
+  if (width <= 0 || height <= 0)
+  {
+    return;
+  }
+  Grid grid = Grid(letters, width, height);
+  solve(grid, sink);
+}
@@ -0,0 +1,39 @@
+#include <vector>
+#include <memory>
+#include "Dictionary.h"
+#include "Grid.h"
+#include "MatchSink.h"
+#include "Search.h"
+#include "AhoCorasick.h"
+
+#ifndef WORDSEARCHER_H
+#define WORDSEARCHER_H
+
+// The solver as a library: an indexed dictionary (buildIndex or
+// loadBinary) and fixed options, then any number of grids. The
+// dictionary is borrowed and must outlive the searcher.
+class WordSearcher
+{
+public:
+  WordSearcher(const Dictionary& dict, SearchOptions options);
+  const Dictionary& getDictionary(void) const { return dict; }
+  const SearchOptions& getOptions(void) const { return options; }
+  // builds the grid's rays first if they are shorter than the longest
+  // word; matches come in scan order (row, column, direction, length)
+  std::vector<Match> solve(Grid& grid) const;
+  // with the worker count overridden, e.g. 1 when grids are already
+  // solved in parallel
+  std::vector<Match> solve(Grid& grid, int workers) const;
+  void solve(Grid& grid, MatchSink& sink) const;
+  // width * height row-major letters; sizes below 1 find nothing
+  std::vector<Match> solve(const char* letters, int width, int height) const;
+  void solve(const char* letters, int width, int height, MatchSink& sink) const;
+private:
+  const Dictionary& dict;
+  SearchOptions options;
+  std::unique_ptr<AhoCorasick> automaton;
+  // Dictionary::countWords for options.minLength, with DEDUP_PRUNE only
+  std::vector<int> wordCounts;
+};
+
+#endif //WORDSEARCHER_H
@@ -0,0 +1,361 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <new>
+#include <atomic>
+#include "../Dictionary.h"
+#include "../Grid.h"
+#include "../Search.h"
+#include "../Batch.h"
+#include "../Incremental.h"
+
+// Host-side benchmark suite: dictionary load, each sort, the encoded
+// dictionary's word storage, lookupWord throughput, end-to-end
+// findMatches and single-letter edits on synthetic grids, and a batch of
+// small grid files on 1 and --workers threads. Heap allocations are
+// counted by replacing the global operator new. The steady-state search
+// (findMatchesInRows into a reused vector) must not allocate; if it
+// does, bench reports it and exits with status 2.
+//
+// bench [--dictionary file | --words n] [--grid size]... [--reps n]
+//       [--lookups n] [--workers n] [--seed n] [--json]
+
+// counted from every thread the solvers start
+static std::atomic<long> allocations(0);
+
+void* operator new(std::size_t size)
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  void* p = std::malloc(size ? size : 1);
+  if (p == NULL)
+  {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+struct Result
+{
+  std::string name;
+  double ms;
+  long allocations;
+  long count;
+};
+
+// selection sort always, and quickSort on sorted input, are quadratic;
+// above this many words they are skipped
+const int QUADRATIC_LIMIT = 20000;
+// random letters changed per grid size for the incremental solver
+const int EDITS = 100;
+// letters weighted roughly like English text so synthetic grids hit words
+const char LETTERS[] = "eeeeeeeeeeeetttttttttaaaaaaaaooooooooiiiiiiinnnnnnnsssssshhhhhhrrrrrrddddllllcccuuummmwwffggyyppbbvkjxqz";
+
+std::vector<Result> results;
+bool json = false;
+bool steadyAllocated = false;
+
+void record(std::string name, double seconds, long allocs, long count)
+{
+  Result result = {name, seconds * 1000.0, allocs, count};
+  results.push_back(result);
+  if (!json)
+  {
+    std::cout << name << ": " << result.ms << " ms, " << allocs << " allocations";
+    if (count > 0)
+    {
+      std::cout << ", " << count << " items (" << count / seconds << "/s)";
+    }
+    std::cout << std::endl;
+  }
+}
+
+// Times reps calls of run and records the per-call average.
+template <typename Run>
+void measure(std::string name, int reps, long count, Run run)
+{
+  long before = allocations;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < reps; i++)
+  {
+    run();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  record(name, elapsed.count() / reps, (allocations - before) / reps, count);
+}
+
+char randomLetter(std::mt19937& rng)
+{
+  return LETTERS[rng() % (sizeof(LETTERS) - 1)];
+}
+
+void writeWords(std::string filename, int count, std::mt19937& rng)
+{
+  std::ofstream outfile(filename);
+  for (int i = 0; i < count; i++)
+  {
+    int length = 3 + rng() % 10;
+    for (int j = 0; j < length; j++)
+    {
+      outfile << randomLetter(rng);
+    }
+    outfile << "\n";
+  }
+}
+
+std::string makeGrid(int size, std::mt19937& rng)
+{
+  std::string text = std::to_string(size) + " " + std::to_string(size) + "\n";
+  text.reserve(text.size() + 2 * size * size);
+  for (int row = 0; row < size; row++)
+  {
+    for (int col = 0; col < size; col++)
+    {
+      text += randomLetter(rng);
+      text += col + 1 < size ? ' ' : '\n';
+    }
+  }
+  return text;
+}
+
+void benchSort(std::string name, const Dictionary& input, void (Dictionary::*sort)(void), bool quadratic)
+{
+  if (quadratic && input.size() > QUADRATIC_LIMIT)
+  {
+    if (!json)
+    {
+      std::cout << name << ": skipped (quadratic)" << std::endl;
+    }
+    return;
+  }
+  Dictionary dict = input;
+  measure(name, 1, input.size(), [&]() { (dict.*sort)(); });
+}
+
+void benchSorts(std::string order, const Dictionary& input, bool sorted)
+{
+  benchSort("sort." + order + ".selection", input, &Dictionary::selectionSort, true);
+  benchSort("sort." + order + ".quick", input, &Dictionary::quickSort, sorted);
+  benchSort("sort." + order + ".heap", input, &Dictionary::heapSort, false);
+  benchSort("sort." + order + ".radix", input, &Dictionary::radixSort, false);
+  benchSort("sort." + order + ".intro", input, &Dictionary::introSort, false);
+}
+
+// Half the probes are dictionary words, half random strings.
+void benchLookups(const Dictionary& dict, int lookups, std::mt19937& rng)
+{
+  std::vector<std::string> probes;
+  for (int i = 0; i < 4096; i++)
+  {
+    if (i % 2 == 0 && dict.size() > 0)
+    {
+      probes.push_back(std::string(dict.getWord(rng() % dict.size())));
+    }
+    else
+    {
+      std::string probe;
+      for (int j = 3 + rng() % 10; j > 0; j--)
+      {
+        probe += randomLetter(rng);
+      }
+      probes.push_back(probe);
+    }
+  }
+  long hits = 0;
+  measure("lookupWord", 1, lookups, [&]() {
+    for (int i = 0; i < lookups; i++)
+    {
+      hits += dict.lookupWord(probes[i % probes.size()]) != -1;
+    }
+  });
+  if (!json)
+  {
+    std::cout << "  " << hits << " hits" << std::endl;
+  }
+}
+
+// The pre-reference search signature: dictionary and grid copied per cell.
+void searchCellByValue(Dictionary dict, Grid grid, int row, int col, std::vector<Match>& matches)
+{
+  searchDirections(dict, grid, row, col, SearchOptions(), NULL, matches);
+}
+
+void benchSearch(const Dictionary& dict, int size, int reps, int workers, std::mt19937& rng)
+{
+  std::istringstream text(makeGrid(size, rng));
+  std::string prefix = "search." + std::to_string(size) + "x" + std::to_string(size);
+  Grid grid = Grid(text);
+  measure(prefix + ".buildRays", 1, 0, [&]() { grid.buildRays(dict.getMax()); });
+
+  SearchOptions options;
+  options.workers = workers;
+  std::vector<Match> matches;
+  measure(prefix + ".findMatches", reps, (long)size * size, [&]() { matches = findMatches(dict, grid, options); });
+  if (!json)
+  {
+    std::cout << "  " << matches.size() << " matches" << std::endl;
+  }
+  SearchOptions hashed = options;
+  hashed.engine = ENGINE_HASH;
+  measure(prefix + ".findMatchesHashed", reps, (long)size * size, [&]() { matches = findMatches(dict, grid, hashed); });
+  SearchOptions distinct = options;
+  distinct.dedup = DEDUP_PRUNE;
+  measure(prefix + ".findMatchesDistinct", reps, (long)size * size, [&]() { matches = findMatches(dict, grid, distinct); });
+  if (!json)
+  {
+    std::cout << "  " << matches.size() << " distinct" << std::endl;
+  }
+
+  // the first pass sizes matches; later passes reuse its capacity
+  matches.clear();
+  findMatchesInRows(dict, grid, 0, size, options, NULL, matches);
+  measure(prefix + ".steadyState", reps, (long)size * size, [&]() {
+    matches.clear();
+    findMatchesInRows(dict, grid, 0, size, options, NULL, matches);
+  });
+  if (results.back().allocations != 0)
+  {
+    std::cerr << prefix << ": steady-state search allocated" << std::endl;
+    steadyAllocated = true;
+  }
+  WordSearcher searcher = WordSearcher(dict, options);
+  IncrementalSolver incremental = IncrementalSolver(searcher, grid);
+  measure(prefix + ".setLetter", EDITS, 1, [&]() { incremental.setLetter(rng() % size, rng() % size, randomLetter(rng)); });
+  if (size <= 16)
+  {
+    measure(prefix + ".byValue", reps, (long)size * size, [&]() {
+      matches.clear();
+      for (int row = 0; row < size; row++)
+      {
+        for (int col = 0; col < size; col++)
+        {
+          searchCellByValue(dict, grid, row, col, matches);
+        }
+      }
+    });
+  }
+}
+
+// BATCH_GRIDS puzzle-sized grid files, solved one per thread.
+const int BATCH_GRIDS = 256;
+
+void benchBatch(const Dictionary& dict, int workers, std::mt19937& rng)
+{
+  std::vector<std::string> filenames;
+  for (int i = 0; i < BATCH_GRIDS; i++)
+  {
+    filenames.push_back("bench-grid-" + std::to_string(i) + ".tmp");
+    std::ofstream outfile(filenames.back());
+    outfile << makeGrid(15, rng);
+  }
+  WordSearcher searcher = WordSearcher(dict, SearchOptions());
+  for (int threads = 1; threads <= workers; threads = threads < workers ? workers : threads + 1)
+  {
+    VectorSink sink;
+    measure("batch.15x15." + std::to_string(threads) + "threads", 1, BATCH_GRIDS, [&]() { solveBatch(searcher, filenames, threads, sink); });
+  }
+  for (int i = 0; i < BATCH_GRIDS; i++)
+  {
+    std::remove(filenames[i].c_str());
+  }
+}
+
+void printJson(void)
+{
+  std::cout << "[\n";
+  for (int i = 0; i < results.size(); i++)
+  {
+    std::cout << "  {\"name\": \"" << results[i].name << "\", \"ms\": " << results[i].ms
+              << ", \"allocations\": " << results[i].allocations
+              << ", \"count\": " << results[i].count << "}"
+              << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  std::cout << "]" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  std::string dictFile = "dictionary.txt";
+  int words = 0;
+  std::vector<int> sizes;
+  int reps = 3;
+  int lookups = 1000000;
+  int workers = 1;
+  unsigned seed = 4993;
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    std::string value = i + 1 < argc ? argv[i + 1] : "";
+    if (arg == "--json") { json = true; continue; }
+    else if (arg == "--dictionary") { dictFile = value; }
+    else if (arg == "--words") { words = std::atoi(value.c_str()); }
+    else if (arg == "--grid") { sizes.push_back(std::atoi(value.c_str())); }
+    else if (arg == "--reps") { reps = std::atoi(value.c_str()); }
+    else if (arg == "--lookups") { lookups = std::atoi(value.c_str()); }
+    else if (arg == "--workers") { workers = std::atoi(value.c_str()); }
+    else if (arg == "--seed") { seed = std::atoi(value.c_str()); }
+    else
+    {
+      std::cerr << "unknown option " << arg << std::endl;
+      return 1;
+    }
+    i++;
+  }
+  if (sizes.empty())
+  {
+    sizes = {15, 64, 256, 1024};
+  }
+  std::mt19937 rng(seed);
+
+  std::string generated = "bench-words.tmp";
+  if (words > 0)
+  {
+    writeWords(generated, words, rng);
+    dictFile = generated;
+  }
+  Dictionary input = Dictionary();
+  measure("readWords", 1, 0, [&]() { input.readWords(dictFile); });
+  if (words > 0)
+  {
+    std::remove(generated.c_str());
+  }
+
+  benchSorts("file", input, false);
+  Dictionary dict = input;
+  dict.radixSort();
+  benchSorts("sorted", dict, true);
+  measure("buildIndex", 1, 0, [&]() { dict.buildIndex(); });
+  Dictionary packed = dict;
+  measure("packWords", 1, packed.size(), [&]() { packed.packWords(); });
+  if (!json)
+  {
+    std::cout << "  word storage " << dict.wordBytes() << " -> " << packed.wordBytes() << " bytes" << std::endl;
+  }
+
+  benchLookups(dict, lookups, rng);
+  for (int i = 0; i < sizes.size(); i++)
+  {
+    benchSearch(dict, sizes[i], reps, workers, rng);
+  }
+  benchBatch(dict, workers, rng);
+
+  if (json)
+  {
+    printJson();
+  }
+  return steadyAllocated ? 2 : 0;
+}
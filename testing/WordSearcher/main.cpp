@@ -1,74 +1,124 @@
 #include <iostream>
 #include <vector>
+#include <fstream>
 #include "Dictionary.h"
 #include "Grid.h"
+#include "Session.h"
+#include "Batch.h"
+#include "Search.h"
+#include "MatchSink.h"
+#include "Stats.h"
 
-const int MIN_LENGTH = 5;
+// worker threads for findMatches, 0 = one per hardware thread
+const int WORKERS = 0;
+// one of the ENGINE_* constants in Search.h
+const int ENGINE = ENGINE_TRIE;
+// one of the DEDUP_* constants in Search.h
+const int DEDUP = DEDUP_OFF;
+// StreamSink::FORMAT_TEXT, FORMAT_CSV or FORMAT_JSON
+const int FORMAT = StreamSink::FORMAT_TEXT;
+// keep dictionary words as packed letter codes where they fit
+const bool PACK_WORDS = false;
+// with -DWS_STATS, print the solver statistics as JSON instead of text
+const bool STATS_JSON = false;
 
-void search(int algorithm);
-void findMatches(Dictionary dict, Grid grid);
-void searchDirections(Dictionary dict, Grid grid, int row, int col);
+SearchOptions searchOptions(void);
+void search(const Session& session);
+int batch(int argc, char** argv);
+int compile(std::string textFile, std::string binaryFile);
 
-int main(){
-  search(1);
-  search(2);
+// main                                   prompt for a grid, twice
+// main --batch grid...                   solve each grid file
+// main --list manifest                   solve the grid files listed
+// main --dir directory                   solve every file in a directory
+// main --stdin                           solve grids read from stdin
+// main --stream grid...                  solve grid files too large to hold
+// main --compile dictionary.txt out.bin  precompile the dictionary
+int main(int argc, char** argv){
+  if (argc == 4 && std::string(argv[1]) == "--compile") {
+    return compile(argv[2], argv[3]);
+  }
+  if (argc > 1) {
+    return batch(argc, argv);
+  }
+  // one dictionary load serves both prompts
+  Session session = Session(1, searchOptions(), PACK_WORDS);
+  search(session);
+  search(session);
 }
 
-void findMatches(Dictionary dict, Grid grid)
+SearchOptions searchOptions(void)
 {
-  int width = grid.getWidth(), height = grid.getHeight();
-  for (int row = 0; row < height; row++) {
-    for (int col = 0; col < width; col++) {
-      searchDirections(dict, grid, row, col);
-    }
-  }
+  SearchOptions options;
+  options.engine = ENGINE;
+  options.workers = WORKERS;
+  options.dedup = DEDUP;
+  return options;
 }
 
-void searchDirections(Dictionary dict, Grid grid, int row, int col)
+void search(const Session& session)
 {
-  // directional arrays
-  int x[] = {-1, -1, -1, 0, 0, 1, 1, 1};
-  int y[] = {-1, 0, 1, -1, 1, -1, 0, 1};
-
-  for (int direction = 0; direction < 8; direction++) {
-    std::string current = "";
-    int rd = row;
-    int cd = col;
+  std::string filename;
+  std::cout << "Please enter the name of the file containing the grid: ";
+  std::cin >> filename;
+  Grid grid = Session::parseGrid(filename);
+  std::vector<Match> matches = session.solve(grid);
+  StreamSink sink = StreamSink(session.getDictionary(), std::cout, FORMAT);
+  for (int i = 0; i < matches.size(); i++) {
+    sink.add(matches[i]);
+  }
+  sink.flush();
+  STATS_DUMP(std::cerr, STATS_JSON);
+}
 
-    while (current.length() <= dict.getMax()) {
-      current += grid.getLetter((((cd % grid.getWidth()) + grid.getWidth()) % grid.getWidth()), (((rd % grid.getHeight()) + grid.getHeight()) % grid.getHeight()));
-      if (current.length() >= MIN_LENGTH) {
-        if (dict.lookupWord(current) != -1) {std::cout << "MATCH: " << current << std::endl;}
+// One session serves every grid of the batch.
+int batch(int argc, char** argv)
+{
+  std::string mode = argv[1];
+  if (mode != "--batch" && mode != "--list" && mode != "--dir" && mode != "--stdin" && mode != "--stream") {
+    std::cerr << "unknown option " << mode << std::endl;
+    return 1;
+  }
+  Session session = Session(3, searchOptions(), PACK_WORDS);
+  StreamSink sink = StreamSink(session.getDictionary(), std::cout, FORMAT);
+  if (mode == "--stdin") {
+    session.solveStream(std::cin, sink);
+  } else if (mode == "--stream") {
+    for (int i = 2; i < argc; i++) {
+      session.streamFile(argv[i], sink);
+    }
+  } else {
+    std::vector<std::string> filenames;
+    for (int i = 2; i < argc; i++) {
+      if (mode == "--batch") {
+        filenames.push_back(argv[i]);
+      } else if (mode == "--dir") {
+        std::vector<std::string> listed = listGrids(argv[i]);
+        filenames.insert(filenames.end(), listed.begin(), listed.end());
+      } else {
+        std::ifstream manifest(argv[i]);
+        std::string filename;
+        while (manifest >> filename) {
+          filenames.push_back(filename);
+        }
       }
-      rd += x[direction];
-      cd += y[direction];
     }
+    session.solveFiles(filenames, sink);
   }
+  sink.flush();
+  STATS_DUMP(std::cerr, STATS_JSON);
+  return 0;
 }
 
-void search(int algorithm)
+int compile(std::string textFile, std::string binaryFile)
 {
   Dictionary dict = Dictionary();
-  dict.readWords("dictionary.txt");
-  
-  switch(algorithm)
-  {
-    case 0:
-      	dict.selectionSort();
-      	break;
-    case 1:
- 	dict.quickSort();
-      	break;
-    case 2:
-      	dict.heapSort(); 
-      	break;
-    default:
-      	dict.quickSort();
-      	break;
+  dict.readWords(textFile);
+  dict.radixSort();
+  dict.buildIndex();
+  if (dict.size() == 0 || !dict.saveBinary(binaryFile)) {
+    std::cerr << "could not compile " << textFile << " into " << binaryFile << std::endl;
+    return 1;
   }
-  std::string filename;
-  std::cout << "Please enter the name of the file containing the grid: ";
-  std::cin >> filename;
-  Grid grid = Grid(filename);
-  findMatches(dict, grid);
+  return 0;
 }